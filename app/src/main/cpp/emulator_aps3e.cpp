@@ -10,6 +10,7 @@
 #include "Emu/system_config.h"
 #include "Emu/Cell/Modules/sceNpTrophy.h"
 #include "Loader/PSF.h"
+#include "Loader/cso.h"
 #include "Loader/TROPUSR.h"
 
 
@@ -55,6 +56,13 @@ static jboolean j_install_edat(JNIEnv* env,jobject self,jint edat_fd){
     return ae::install_edat(edat_f);
 }
 
+static jboolean j_compress_iso(JNIEnv* env,jobject self,jint iso_fd,jint cso_fd){
+    const bool result=cso_compress(iso_fd,cso_fd,0x10000,nullptr);
+    close(iso_fd);
+    close(cso_fd);
+    return result;
+}
+
 static jobject j_meta_info_from_dir(JNIEnv* env,jobject self,jstring jdir_path){
 
     auto fetch_psf_path=[](const std::string& dir_path){
@@ -1007,6 +1015,7 @@ int register_aps3e_Emulator(JNIEnv* env){
             { "meta_info_from_dir","(Ljava/lang/String;)Laenu/aps3e/Emulator$MetaInfo;",(void*)j_meta_info_from_dir},
 
             { "meta_info_from_iso","(ILjava/lang/String;)Laenu/aps3e/Emulator$MetaInfo;",(void*)j_meta_info_from_iso},
+            { "compress_iso","(II)Z",(void*)j_compress_iso},
 
             { "setup_game_id", "(Ljava/lang/String;)V", (void *) j_setup_game_id },
             {"install_edat", "(I)Z", (void *) j_install_edat},
@@ -47,7 +47,7 @@ namespace ae{
             return;
         }
 
-        return cpu_thread::suspend_all(nullptr, {}, [&]
+        return cpu_thread::suspend_range(addr, sizeof(T), [&]
         {
             if (!vm::check_addr<sizeof(T)>(addr))
             {
@@ -114,6 +114,52 @@ uint64_t meminfo_sys_mem_usage_kb(){
     return total_mem - available_mem;
 }
 
+uint64_t meminfo_sys_mem_total_kb(){
+    std::ifstream maps_file("/proc/meminfo");
+    std::string line;
+    uint64_t total_mem = 0;
+    while (std::getline(maps_file, line)) {
+        if (line.find("MemTotal:") != std::string::npos) {
+            sscanf(line.c_str(), "MemTotal: %lu kB", &total_mem);
+            break;
+        }
+    }
+    return total_mem;
+}
+
+uint64_t meminfo_sys_mem_available_kb(){
+    std::ifstream maps_file("/proc/meminfo");
+    std::string line;
+    uint64_t available_mem = 0;
+    while (std::getline(maps_file, line)) {
+        if (line.find("MemAvailable:") != std::string::npos) {
+            sscanf(line.c_str(), "MemAvailable: %lu kB", &available_mem);
+            break;
+        }
+    }
+    return available_mem;
+}
+
+float meminfo_psi_memory_avg10(bool full){
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    // full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    std::ifstream psi_file("/proc/pressure/memory");
+    if(!psi_file.is_open())
+        return -1.f;
+
+    const char* prefix = full ? "full " : "some ";
+    std::string line;
+    while (std::getline(psi_file, line)) {
+        if (line.rfind(prefix, 0) == 0) {
+            float avg10 = -1.f;
+            if (sscanf(line.c_str() + 5, "avg10=%f", &avg10) == 1)
+                return avg10;
+            break;
+        }
+    }
+    return -1.f;
+}
+
 uint64_t meminfo_gpu_mem_usage_kb(){
     std::ifstream maps_file("/proc/meminfo");
     std::string line;
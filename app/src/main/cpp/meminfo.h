@@ -25,6 +25,12 @@ std::string meminfo_print_calc_total_mem(const std::vector<mem_map_entry_t>& mem
 std::string meminfo_to_string(const std::vector<mem_map_entry_t>& mem_map,int step_size=1);
 
 float meminfo_sys_mem_usage(float scale=1.0);
+uint64_t meminfo_sys_mem_total_kb();
+uint64_t meminfo_sys_mem_available_kb();
+
+// Linux PSI (/proc/pressure/memory) stall percentage over the last 10 seconds.
+// Returns a negative value if the kernel does not expose PSI.
+float meminfo_psi_memory_avg10(bool full=false);
 
 uint64_t meminfo_gpu_mem_usage_kb();
 std::string meminfo_gpu_mem_usage();
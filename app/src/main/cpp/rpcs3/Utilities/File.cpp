@@ -1788,7 +1788,8 @@ fs::file::file(const void* ptr, usz size)
 
 fs::file::file(iso_fs& _iso_fs, const std::string& entry_path)
 {
-    if(!_iso_fs.exists(entry_path)) {
+    const iso_fs::entry_t* entry = _iso_fs.get_entry(entry_path);
+    if(!entry) {
         g_tls_error = fs::error::noent;
         return;
     }
@@ -1797,9 +1798,9 @@ fs::file::file(iso_fs& _iso_fs, const std::string& entry_path)
     {
         u64 m_pos{};
         iso_fs& m_iso_fs;
-        iso_fs::entry_t bind_entry;
+        const iso_fs::entry_t& bind_entry;
     public:
-        iso_inner_stream(iso_fs& _iso_fs,iso_fs::entry_t bind_entry)
+        iso_inner_stream(iso_fs& _iso_fs,const iso_fs::entry_t& bind_entry)
                 : m_iso_fs(_iso_fs),bind_entry(bind_entry)
         {
         }
@@ -1812,11 +1813,7 @@ fs::file::file(iso_fs& _iso_fs, const std::string& entry_path)
             stat_t info;
             info.is_directory=bind_entry.is_dir;
             info.is_writable=false;
-#if 0
-            info.size=bind_entry.size();
-#else
             info.size=bind_entry.size;
-#endif
             info.atime=bind_entry.time;
             info.mtime=bind_entry.time;
             info.ctime=bind_entry.time;
@@ -1830,84 +1827,26 @@ fs::file::file(iso_fs& _iso_fs, const std::string& entry_path)
         {
             return false;
         }
-#if 0
-        iso_fs::block_t& locate_block(u64 offset)
-        {
-            for(auto& block:bind_entry.blocks) {
-                if(offset>=block.entry_offset&&offset<block.entry_offset+block.size)
-                    return block;
-            }
-            //不可能执行到这里
-            return bind_entry.blocks.back();
-        }
-#endif
+
         u64 read(void* buffer, u64 count) override
         {
-#if 0
-            const u64 size=bind_entry.size();
-            if (m_pos < size)
-            {
-                // Get readable size
-                if (const u64 result = std::min<u64>(count, size - m_pos))
-                {
-                    u64 remaining=result;
-                    u64 pos=m_pos;
-                    while(remaining>0) {
-                        iso_fs::block_t& block=locate_block(pos);
-                        u64 read_size=std::min<u64>(remaining,block.size-(pos-block.entry_offset));
-                        m_iso_fs.seek(block.offset+(pos-block.entry_offset));
-                        m_iso_fs.read(static_cast<u8*>(buffer)+(pos-m_pos),read_size);
-                        pos+=read_size;
-                        remaining-=read_size;
-                    }
-                    m_pos += result;
-                    return result;
-                }
-            }
-#else
             if(m_pos < bind_entry.size) {
                 if(const u64 result = std::min<u64>(count, bind_entry.size - m_pos)) {
-                    m_iso_fs.seek(bind_entry.offset + m_pos);
-                    m_iso_fs.read(static_cast<u8 *>(buffer), result);
-                    m_pos += result;
-                    return result;
+                    const u64 nread = m_iso_fs.read_entry(bind_entry, m_pos, static_cast<u8 *>(buffer), result);
+                    m_pos += nread;
+                    return nread;
                 }
             }
-#endif
             return 0;
         }
 
         u64 read_at(u64 offset, void* buffer, u64 count) override
         {
-#if 0
-            const u64 size=bind_entry.size();
-            if (offset < size)
-            {
-                // Get readable size
-                if (const u64 result = std::min<u64>(count, size - offset))
-                {
-                    u64 remaining=result;
-                    u64 pos=m_pos;
-                    while(remaining>0) {
-                        iso_fs::block_t& block=locate_block(pos);
-                        u64 read_size=std::min<u64>(remaining,block.size-(pos-block.entry_offset));
-                        m_iso_fs.seek(block.offset+(pos-block.entry_offset));
-                        m_iso_fs.read(static_cast<u8*>(buffer)+(pos-m_pos),read_size);
-                        pos+=read_size;
-                        remaining-=read_size;
-                    }
-                    return result;
-                }
-            }
-#else
             if(offset < bind_entry.size) {
                 if(const u64 result = std::min<u64>(count, bind_entry.size - offset)) {
-                    m_iso_fs.seek(bind_entry.offset + offset);
-                    m_iso_fs.read(static_cast<u8 *>(buffer), result);
-                    return result;
+                    return m_iso_fs.read_entry(bind_entry, offset, static_cast<u8 *>(buffer), result);
                 }
             }
-#endif
             return 0;
         }
 
@@ -1935,15 +1874,11 @@ fs::file::file(iso_fs& _iso_fs, const std::string& entry_path)
 
         u64 size() override
         {
-#if 0
-            return bind_entry.size();
-#else
             return bind_entry.size;
-#endif
         }
     };
 
-    m_file = std::make_unique<iso_inner_stream>(_iso_fs, _iso_fs.get_entry(entry_path));
+    m_file = std::make_unique<iso_inner_stream>(_iso_fs, *entry);
 }
 
 fs::native_handle fs::file::get_handle() const
@@ -1990,13 +1925,12 @@ bool fs::dir::open(const std::string& path)
 
         class iso_inner_dir final : public dir_base
         {
-            iso_fs& m_iso_fs;
-            std::vector<iso_fs::entry_t>& list;
+            std::span<const iso_fs::entry_t> list;
             size_t pos;
 
         public:
             iso_inner_dir(iso_fs& _iso_fs, const std::string& entry_path)
-                    : m_iso_fs(_iso_fs),list(m_iso_fs.list_dir(entry_path)),pos(0)
+                    : list(_iso_fs.list_dir(entry_path)),pos(0)
             {
             }
 
@@ -2011,20 +1945,15 @@ bool fs::dir::open(const std::string& path)
                     return false;
                 }
 
-                iso_fs::entry_t& entry=list[pos++];
+                const iso_fs::entry_t& entry=list[pos++];
 
-                info.name = entry.path.substr(entry.path.rfind('/') + 1);
+                info.name = entry.path.substr(entry.path.find_last_of("/:") + 1);
                 info.is_directory = entry.is_dir;
                 info.is_writable = false;
-#if 0
-                info.size = entry.size();
-#else
-                info.size = entry.size;;
-#endif
-                //FIXME
-                info.atime = 0;
-                info.mtime = 0;
-                info.ctime = 0;
+                info.size = entry.size;
+                info.atime = entry.time;
+                info.mtime = entry.time;
+                info.ctime = entry.time;
 
                 return true;
             }
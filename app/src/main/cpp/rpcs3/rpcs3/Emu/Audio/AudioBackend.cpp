@@ -3,6 +3,7 @@
 #include "Emu/system_config.h"
 #include "Emu/IdManager.h"
 #include "Emu//Cell/Modules/cellAudioOut.h"
+#include "util/simd.hpp"
 
 AudioBackend::AudioBackend() {}
 
@@ -48,7 +49,17 @@ bool AudioBackend::get_convert_to_s16() const
 
 void AudioBackend::convert_to_s16(u32 cnt, const f32* src, void* dst)
 {
-	for (u32 i = 0; i < cnt; i++)
+	u32 i = 0;
+
+	// Safe in place: each iteration reads 32 bytes before writing the first 16 of them
+	for (; i + 8 <= cnt; i += 8)
+	{
+		const v128 lo = gv_cvtfs_tos32(gv_minfs(gv_maxfs(gv_mulfs(v128::loadu(src + i), 32768.5f), gv_bcstfs(-32768.0f)), gv_bcstfs(32767.0f)));
+		const v128 hi = gv_cvtfs_tos32(gv_minfs(gv_maxfs(gv_mulfs(v128::loadu(src + i + 4), 32768.5f), gv_bcstfs(-32768.0f)), gv_bcstfs(32767.0f)));
+		v128::storeu(gv_packss_s32(lo, hi), static_cast<s16*>(dst) + i);
+	}
+
+	for (; i < cnt; i++)
 	{
 		static_cast<s16*>(dst)[i] = static_cast<s16>(std::clamp(src[i] * 32768.5f, -32768.0f, 32767.0f));
 	}
@@ -97,7 +108,14 @@ f32 AudioBackend::apply_volume(const VolumeParam& param, u32 sample_cnt, const f
 
 void AudioBackend::apply_volume_static(f32 vol, u32 sample_cnt, const f32* src, f32* dst)
 {
-	for (u32 i = 0; i < sample_cnt; i++)
+	u32 i = 0;
+
+	for (; i + 4 <= sample_cnt; i += 4)
+	{
+		v128::storeu(gv_mulfs(v128::loadu(src + i), vol), dst + i);
+	}
+
+	for (; i < sample_cnt; i++)
 	{
 		dst[i] = src[i] * vol;
 	}
@@ -105,7 +123,14 @@ void AudioBackend::apply_volume_static(f32 vol, u32 sample_cnt, const f32* src,
 
 void AudioBackend::normalize(u32 sample_cnt, const f32* src, f32* dst)
 {
-	for (u32 i = 0; i < sample_cnt; i++)
+	u32 i = 0;
+
+	for (; i + 4 <= sample_cnt; i += 4)
+	{
+		v128::storeu(gv_minfs(gv_maxfs(v128::loadu(src + i), gv_bcstfs(-1.0f)), gv_bcstfs(1.0f)), dst + i);
+	}
+
+	for (; i < sample_cnt; i++)
 	{
 		dst[i] = std::clamp<f32>(src[i], -1.0f, 1.0f);
 	}
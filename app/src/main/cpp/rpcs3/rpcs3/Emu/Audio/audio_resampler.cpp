@@ -15,24 +15,117 @@ audio_resampler::~audio_resampler()
 void audio_resampler::set_params(AudioChannelCnt ch_cnt, AudioFreq freq)
 {
 	flush();
+	this->ch_cnt = static_cast<u32>(ch_cnt);
 	resampler.setChannels(static_cast<u32>(ch_cnt));
 	resampler.setSampleRate(static_cast<u32>(freq));
 }
 
-f64 audio_resampler::set_tempo(f64 new_tempo)
+f64 audio_resampler::set_tempo(f64 new_tempo, bool allow_linear)
 {
 	new_tempo = std::clamp(new_tempo, RESAMPLER_MIN_FREQ_VAL, RESAMPLER_MAX_FREQ_VAL);
+	set_linear(allow_linear && new_tempo >= RESAMPLER_LINEAR_MIN_FREQ_VAL);
 	resampler.setTempo(new_tempo);
+	tempo = new_tempo;
 	return new_tempo;
 }
 
+void audio_resampler::set_linear(bool enable)
+{
+	if (use_linear == enable)
+	{
+		return;
+	}
+
+	use_linear = enable;
+
+	if (enable)
+	{
+		// Keep what SoundTouch has already produced. The few ms still in its pipeline are dropped,
+		// flushing them out would pad the stream with silence instead.
+		const u32 ready = resampler.numSamples();
+		linear_out.insert(linear_out.end(), resampler.bufBegin(), resampler.bufBegin() + ready * ch_cnt);
+		resampler.clear();
+		return;
+	}
+
+	// Hand the input that was not interpolated yet over to SoundTouch
+	const usz first = static_cast<usz>(linear_pos) * ch_cnt;
+
+	if (first < linear_in.size())
+	{
+		resampler.putSamples(linear_in.data() + first, static_cast<u32>((linear_in.size() - first) / ch_cnt));
+	}
+
+	linear_in.clear();
+	linear_pos = 0.0;
+}
+
 void audio_resampler::put_samples(const f32* buf, u32 sample_cnt)
 {
-	resampler.putSamples(buf, sample_cnt);
+	if (!use_linear)
+	{
+		resampler.putSamples(buf, sample_cnt);
+		return;
+	}
+
+	// Drop output that was already handed out
+	linear_out.erase(linear_out.begin(), linear_out.begin() + usz{linear_out_pos} * ch_cnt);
+	linear_out_pos = 0;
+
+	linear_in.insert(linear_in.end(), buf, buf + usz{sample_cnt} * ch_cnt);
+
+	const usz in_frames = linear_in.size() / ch_cnt;
+
+	if (in_frames < 2)
+	{
+		return;
+	}
+
+	linear_out.reserve(linear_out.size() + static_cast<usz>((in_frames - linear_pos) / tempo + 1) * ch_cnt);
+
+	// Interpolate between frame idx and idx + 1, the last frame is kept as the left neighbour for the next call
+	while (linear_pos + 1.0 < in_frames)
+	{
+		const usz idx = static_cast<usz>(linear_pos);
+		const f32 frac = static_cast<f32>(linear_pos - idx);
+		const f32* a = linear_in.data() + idx * ch_cnt;
+		const f32* b = a + ch_cnt;
+
+		for (u32 ch = 0; ch < ch_cnt; ch++)
+		{
+			linear_out.push_back(a[ch] + (b[ch] - a[ch]) * frac);
+		}
+
+		linear_pos += tempo;
+	}
+
+	const usz consumed = std::min<usz>(static_cast<usz>(linear_pos), in_frames - 1);
+	linear_in.erase(linear_in.begin(), linear_in.begin() + consumed * ch_cnt);
+	linear_pos -= static_cast<f64>(consumed);
 }
 
 std::pair<f32* /* buffer */, u32 /* samples */> audio_resampler::get_samples(u32 sample_cnt)
 {
+	// Output left over from the linear path (also after switching to SoundTouch) has to go out first
+	if (const u32 linear_avail = static_cast<u32>(linear_out.size() / ch_cnt) - linear_out_pos)
+	{
+		f32* const buf = linear_out.data() + usz{linear_out_pos} * ch_cnt;
+		const u32 cnt = std::min(sample_cnt, linear_avail);
+		linear_out_pos += cnt;
+		return std::make_pair(buf, cnt);
+	}
+
+	if (use_linear)
+	{
+		return std::make_pair(linear_out.data(), 0u);
+	}
+
+	if (!linear_out.empty())
+	{
+		linear_out.clear();
+		linear_out_pos = 0;
+	}
+
 	// NOTE: Make sure to get the buffer first because receiveSamples advances its position internally
 	//       and std::make_pair evaluates the second parameter first...
 	f32 *const buf = resampler.bufBegin();
@@ -41,15 +134,20 @@ std::pair<f32* /* buffer */, u32 /* samples */> audio_resampler::get_samples(u32
 
 u32 audio_resampler::samples_available() const
 {
-	return resampler.numSamples();
+	const u32 linear_avail = static_cast<u32>(linear_out.size() / ch_cnt) - linear_out_pos;
+	return use_linear ? linear_avail : linear_avail + resampler.numSamples();
 }
 
 f64 audio_resampler::get_resample_ratio()
 {
-	return resampler.getInputOutputSampleRatio();
+	return use_linear ? tempo : resampler.getInputOutputSampleRatio();
 }
 
 void audio_resampler::flush()
 {
 	resampler.clear();
+	linear_in.clear();
+	linear_out.clear();
+	linear_out_pos = 0;
+	linear_pos = 0.0;
 }
@@ -13,9 +13,16 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <vector>
+
 constexpr f64 RESAMPLER_MAX_FREQ_VAL = 1.0;
 constexpr f64 RESAMPLER_MIN_FREQ_VAL = 0.1;
 
+// When allowed by the caller, tempo corrections down to this value are done by plain linear interpolation instead of
+// SoundTouch's time stretching (which also adds ~20ms of latency). This shifts the pitch by the same amount, so the band
+// is kept within ~1% (about a sixth of a semitone).
+constexpr f64 RESAMPLER_LINEAR_MIN_FREQ_VAL = 0.99;
+
 class audio_resampler
 {
 public:
@@ -23,7 +30,7 @@ public:
 	~audio_resampler();
 
 	void set_params(AudioChannelCnt ch_cnt, AudioFreq freq);
-	f64 set_tempo(f64 new_tempo);
+	f64 set_tempo(f64 new_tempo, bool allow_linear = false);
 
 	void put_samples(const f32* buf, u32 sample_cnt);
 	std::pair<f32* /* buffer */, u32 /* samples */> get_samples(u32 sample_cnt);
@@ -31,8 +38,27 @@ public:
 	u32 samples_available() const;
 	f64 get_resample_ratio();
 
+	// True if the current tempo is handled by SoundTouch
+	bool is_time_stretching() const
+	{
+		return !use_linear;
+	}
+
 	void flush();
 
 private:
+	void set_linear(bool enable);
+
 	soundtouch::SoundTouch resampler{};
+
+	bool use_linear = false;
+	u32 ch_cnt = 2;
+	f64 tempo = RESAMPLER_MAX_FREQ_VAL;
+
+	// Linear resampler state, in interleaved frames. Output is kept until the next put_samples so that the pointer
+	// returned by get_samples stays valid (callers convert the data in place).
+	f64 linear_pos = 0.0;
+	std::vector<f32> linear_in{};
+	std::vector<f32> linear_out{};
+	u32 linear_out_pos = 0;
 };
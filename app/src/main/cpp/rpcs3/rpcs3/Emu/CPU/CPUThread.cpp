@@ -27,6 +27,8 @@
 DECLARE(cpu_thread::g_threads_created){0};
 DECLARE(cpu_thread::g_threads_deleted){0};
 DECLARE(cpu_thread::g_suspend_counter){0};
+DECLARE(cpu_thread::g_suspend_full_count){0};
+DECLARE(cpu_thread::g_suspend_range_count){0};
 
 LOG_CHANNEL(profiler);
 LOG_CHANNEL(sys_log, "SYS");
@@ -1410,6 +1412,7 @@ bool cpu_thread::suspend_work::push(cpu_thread* _this) noexcept
 
 		// Initialization (first increment)
 		g_suspend_counter += 2;
+		g_suspend_full_count++;
 
 		// Copy snapshot for finalization
 		u128 copy2 = copy;
@@ -1525,6 +1528,68 @@ bool cpu_thread::suspend_work::push(cpu_thread* _this) noexcept
 	return true;
 }
 
+void cpu_thread::suspend_work::push_range(u32 addr, u32 size) noexcept
+{
+	// Limited to two pages and 33 reservation lines (4096 unaligned bytes)
+	if (size && size <= 4096 && addr + size > addr && vm::check_addr(addr, vm::page_readable, size))
+	{
+		const auto is_code = [&]()
+		{
+			// Code may be executed by any thread at any time, patching it needs all threads stopped
+			return vm::check_addr(addr, vm::page_executable) || vm::check_addr(addr + size - 1, vm::page_executable);
+		};
+
+		const u32 first = addr & -128;
+		const u32 last = (addr + size - 1) & -128;
+
+		if (!is_code())
+		{
+			// Lock reservations in ascending order, threads doing an atomic store in the range are waited for
+			for (u32 line = first; line <= last; line += 128)
+			{
+				vm::reservation_shared_lock_internal(vm::reservation_acquire(line));
+			}
+
+			bool executed = false;
+			{
+				// Blocks memory mapping changes and unlocked range accesses until done
+				vm::writer_lock lock(addr);
+
+				// Page flags may have changed before the lock was acquired
+				if (vm::check_addr(addr, vm::page_readable, size) && !is_code())
+				{
+					exec(func_ptr, res_buf);
+					executed = true;
+				}
+			}
+
+			for (u32 line = first; line <= last; line += 128)
+			{
+				auto& res = vm::reservation_acquire(line);
+
+				if (executed)
+				{
+					// Release the lock and progress, any reservation held on this line is lost
+					res += 127;
+					res.notify_all();
+				}
+				else
+				{
+					res -= 1;
+				}
+			}
+
+			if (executed)
+			{
+				g_suspend_range_count++;
+				return;
+			}
+		}
+	}
+
+	push(nullptr);
+}
+
 void cpu_thread::cleanup() noexcept
 {
 	if (u64 count = s_cpu_counter)
@@ -1532,7 +1597,10 @@ void cpu_thread::cleanup() noexcept
 		fmt::throw_exception("cpu_thread::cleanup(): %u threads are still active! (created=%u, destroyed=%u)", count, +g_threads_created, +g_threads_deleted);
 	}
 
-	sys_log.notice("All CPU threads have been stopped. [+: %u]", +g_threads_created);
+	sys_log.notice("All CPU threads have been stopped. [+: %u] (suspensions: %u full, %u range)", +g_threads_created, +g_suspend_full_count, +g_suspend_range_count);
+
+	g_suspend_full_count = 0;
+	g_suspend_range_count = 0;
 
 	g_threads_deleted -= g_threads_created.load();
 	g_threads_created = 0;
@@ -160,6 +160,9 @@ public:
 	// Thread stats for external observation
 	static atomic_t<u64> g_threads_created, g_threads_deleted, g_suspend_counter;
 
+	// Suspension stats: every thread paused vs. only a memory range locked
+	static atomic_t<u64> g_suspend_full_count, g_suspend_range_count;
+
 	// Get thread name (as assigned to named_thread)
 	std::string get_name() const;
 
@@ -219,6 +222,9 @@ public:
 
 		// Internal method
 		bool push(cpu_thread* _this) noexcept;
+
+		// Internal method for suspend_range
+		void push_range(u32 addr, u32 size) noexcept;
 	};
 
 	// Suspend all threads and execute op (may be executed by other thread than caller!)
@@ -251,6 +257,35 @@ public:
 		}
 	}
 
+	// Execute op with exclusive access to guest data in [addr, addr + size) (may be executed by other thread than caller!)
+	// Only threads using reservations in this range are held back, code or unmapped memory falls back to suspend_all
+	template <typename F>
+	static auto suspend_range(u32 addr, u32 size, F op)
+	{
+		if constexpr (std::is_void_v<std::invoke_result_t<F>>)
+		{
+			suspend_work work{0, false, false, 0, nullptr, &op, nullptr, [](void* func, void*)
+			{
+				std::invoke(*static_cast<F*>(func));
+			}};
+
+			work.push_range(addr, size);
+			return;
+		}
+		else
+		{
+			std::invoke_result_t<F> result;
+
+			suspend_work work{0, false, false, 0, nullptr, &op, &result, [](void* func, void* res_buf)
+			{
+				*static_cast<std::invoke_result_t<F>*>(res_buf) = std::invoke(*static_cast<F*>(func));
+			}};
+
+			work.push_range(addr, size);
+			return result;
+		}
+	}
+
 	template <u8 Prio = 0, typename F>
 	static suspend_work suspend_post(cpu_thread* /*_this*/, std::initializer_list<void*> hints, F& op)
 	{
@@ -1,5 +1,7 @@
 #include "stdafx.h"
 #include "Emu/perf_meter.hpp"
+#include "Emu/memory_governor.hpp"
+#include "Emu/system_config.h"
 #include "Emu/Cell/PPUModule.h"
 #include "Emu/Cell/lv2/sys_sync.h"
 #include "Emu/Cell/lv2/sys_ppu_thread.h"
@@ -7,9 +9,15 @@
 #include "sysPrxForUser.h"
 #include "util/asm.hpp"
 #include "util/media_utils.h"
+#include "Utilities/mutex.h"
 
 #include "cellAtracXdec.h"
 
+#include <list>
+#include <unordered_map>
+
+#include "xxhash.h"
+
 vm::gvar<CellAdecCoreOps> g_cell_adec_core_ops_atracx2ch;
 vm::gvar<CellAdecCoreOps> g_cell_adec_core_ops_atracx6ch;
 vm::gvar<CellAdecCoreOps> g_cell_adec_core_ops_atracx8ch;
@@ -103,6 +111,162 @@ constexpr u32 atracXdecGetSpursMemSize(u32 nch_in)
 	}
 }
 
+// Decoded PCM of previously seen access units, so that sound effects and music loops that are replayed over and over
+// only go through FFmpeg once. ATRAC3plus frames overlap, the output of a frame depends on every frame decoded before it
+// in the same sequence. Keys therefore chain the hash of each access unit onto the key of the previous one, starting
+// from the decoder parameters, and a hit is exact as long as the whole sequence prefix is identical.
+struct atracx_pcm_cache
+{
+	// Access units kept for catching up after a streak of hits. The overlap between frames only reaches a few frames back,
+	// so feeding the most recent ones is enough to warm FFmpeg back up (but the result is no longer bit exact).
+	static constexpr usz max_pending_aus = 8;
+
+	struct entry_t
+	{
+		std::vector<f32> samples; // Planar FFmpeg output
+		u32 nb_samples;
+		std::list<u64>::iterator lru;
+	};
+
+	// Per decoder context. Kept on the host since AtracXdecContext lives in guest memory with a fixed layout.
+	struct sequence_t
+	{
+		u64 key = 0;             // 0 if caching is disabled until the next sequence starts
+		std::vector<u8> pending; // Access units served from the cache, they are fed to FFmpeg on the next miss to catch up
+		bool truncated = false;  // Older access units were dropped from pending
+	};
+
+	shared_mutex mutex;
+	std::unordered_map<u64, entry_t> entries;
+	std::list<u64> lru; // Most recently used first
+	std::unordered_map<u32, sequence_t> sequences;
+	atomic_t<u64> total_size = 0; // Including pending access units
+	u32 pool_id = 0;
+
+	atomic_t<u64> hits = 0;
+	atomic_t<u64> misses = 0;
+	atomic_t<u64> decode_ns = 0; // Time spent in FFmpeg for misses, used to estimate the time saved by hits
+
+	atracx_pcm_cache()
+	{
+		if (!g_cfg.audio.atracx_pcm_cache)
+		{
+			return;
+		}
+
+		pool_id = rpcs3::memory_governor::register_pool({ "ATRAC3plus decoding cache", rpcs3::memory_governor::pool_priority::host_cache,
+			[this]() { return total_size.load(); },
+			[this](rpcs3::memory_governor::pressure_level level)
+			{
+				const u64 old_size = total_size;
+				std::lock_guard lock(mutex);
+				evict(level >= rpcs3::memory_governor::pressure_level::severe ? 0 : old_size / 2);
+				return old_size - total_size;
+			} });
+	}
+
+	~atracx_pcm_cache()
+	{
+		if (pool_id)
+		{
+			rpcs3::memory_governor::unregister_pool(pool_id);
+		}
+
+		if (hits || misses)
+		{
+			cellAtracXdec.notice("ATRAC3plus decoding cache: %s", format_stats());
+		}
+	}
+
+	// Queue an access unit served from the cache for the next catch up
+	void push_pending(sequence_t& sequence, const u8* au, u32 nbytes)
+	{
+		std::lock_guard lock(mutex);
+
+		if (sequence.pending.size() >= max_pending_aus * nbytes)
+		{
+			sequence.pending.erase(sequence.pending.begin(), sequence.pending.begin() + nbytes);
+			sequence.truncated = true;
+			total_size -= nbytes;
+		}
+
+		sequence.pending.insert(sequence.pending.end(), au, au + nbytes);
+		total_size += nbytes;
+		evict(g_cfg.audio.atracx_pcm_cache_size * u64{0x100000});
+	}
+
+	// Must be called with the lock held, returns the access units that were pending
+	std::vector<u8> take_pending(sequence_t& sequence)
+	{
+		total_size -= sequence.pending.size();
+		sequence.truncated = false;
+		return std::exchange(sequence.pending, {});
+	}
+
+	// Must be called with the lock held, pending access units are not evicted but count towards max_size
+	void evict(u64 max_size)
+	{
+		while (total_size > max_size && !lru.empty())
+		{
+			const auto found = entries.find(lru.back());
+			total_size -= found->second.samples.size() * sizeof(f32);
+			entries.erase(found);
+			lru.pop_back();
+		}
+	}
+
+	// Copies the cached planes to dst, returns the sample count or -1 on a miss
+	s32 load(u64 key, f32* dst, u32 nch)
+	{
+		std::lock_guard lock(mutex);
+
+		const auto found = entries.find(key);
+
+		if (found == entries.end() || found->second.samples.size() != usz{nch} * ATXDEC_SAMPLES_PER_FRAME)
+		{
+			return -1;
+		}
+
+		lru.splice(lru.begin(), lru, found->second.lru);
+		std::memcpy(dst, found->second.samples.data(), found->second.samples.size() * sizeof(f32));
+		return found->second.nb_samples;
+	}
+
+	void store(u64 key, const AVFrame* frame, u32 nch)
+	{
+		entry_t entry{};
+		entry.nb_samples = frame->nb_samples;
+		entry.samples.resize(usz{nch} * ATXDEC_SAMPLES_PER_FRAME);
+
+		for (u32 ch = 0; ch < nch; ch++)
+		{
+			std::memcpy(&entry.samples[usz{ch} * ATXDEC_SAMPLES_PER_FRAME], frame->data[ch], ATXDEC_SAMPLES_PER_FRAME * sizeof(f32));
+		}
+
+		const u64 size = entry.samples.size() * sizeof(f32);
+
+		std::lock_guard lock(mutex);
+
+		if (const auto [it, inserted] = entries.try_emplace(key, std::move(entry)); inserted)
+		{
+			lru.push_front(key);
+			it->second.lru = lru.begin();
+			total_size += size;
+			evict(g_cfg.audio.atracx_pcm_cache_size * u64{0x100000});
+		}
+	}
+
+	std::string format_stats() const
+	{
+		const u64 hit_count = hits;
+		const u64 miss_count = misses;
+		const u64 saved_us = miss_count ? decode_ns / miss_count * hit_count / 1000 : 0;
+
+		return fmt::format("%llu hits, %llu misses (%llu%%), %llu entries (%lluK), ~%llu ms of decoding saved",
+			hit_count, miss_count, hit_count * 100 / std::max<u64>(hit_count + miss_count, 1), lru.size(), total_size / 1024, saved_us / 1000);
+	}
+};
+
 void AtracXdecDecoder::alloc_avcodec()
 {
 	codec = avcodec_find_decoder(AV_CODEC_ID_ATRAC3P);
@@ -466,9 +630,94 @@ void AtracXdecContext::exec(ppu_thread& ppu)
 				output.set(work_mem.addr() + atracXdecGetSpursMemSize(decoder.nch_in));
 
 				const auto au_start_addr = atracx_param.au_includes_ats_hdr_flg == CELL_ADEC_ATRACX_ATS_HDR_INC ? cmd.au_start_addr.get_ptr() + sizeof(AtracXdecAtsHeader) : cmd.au_start_addr.get_ptr();
-				std::memcpy(work_mem.get_ptr(), au_start_addr, decoder.nbytes);
 
-				if (int err = avcodec_send_packet(decoder.ctx, decoder.packet); err)
+				// FFmpeg output planes, see get_buffer2 in alloc_avcodec()
+				const auto planes = reinterpret_cast<f32*>(work_mem.get_ptr() + ATXDEC_MAX_FRAME_LENGTH);
+
+				atracx_pcm_cache* const cache = g_cfg.audio.atracx_pcm_cache ? &g_fxo->get<atracx_pcm_cache>() : nullptr;
+				atracx_pcm_cache::sequence_t* sequence = nullptr;
+				u64 cache_key = 0;
+				s32 cached_samples = -1;
+
+				if (cache)
+				{
+					{
+						std::lock_guard lock(cache->mutex);
+						sequence = &cache->sequences[work_mem.addr()];
+					}
+
+					if (first_decode)
+					{
+						const u32 params[4]{ decoder.sampling_freq, decoder.ch_config_idx, decoder.nbytes, decoder.nch_in };
+						sequence->key = XXH3_64bits(params, sizeof(params)) | 1;
+
+						std::lock_guard lock(cache->mutex);
+						cache->take_pending(*sequence);
+					}
+
+					if (sequence->key)
+					{
+						cache_key = XXH3_64bits_withSeed(au_start_addr, decoder.nbytes, sequence->key) | 1;
+						cached_samples = cache->load(cache_key, planes, decoder.nch_in);
+					}
+				}
+
+				if (cached_samples >= 0)
+				{
+					// Skip FFmpeg, the decoder state is brought up to date if the sequence diverges later
+					cache->hits++;
+					sequence->key = cache_key;
+					cache->push_pending(*sequence, au_start_addr, decoder.nbytes);
+
+					for (u32 ch = 0; ch < decoder.nch_in; ch++)
+					{
+						decoder.frame->data[ch] = reinterpret_cast<u8*>(planes + usz{ch} * ATXDEC_SAMPLES_PER_FRAME);
+					}
+
+					decoder.frame->nb_samples = cached_samples;
+				}
+				else if (int err = [&]
+				{
+					const auto start = std::chrono::steady_clock::now();
+
+					// Catch up on access units that were served from the cache (at most max_pending_aus), their output is discarded
+					if (sequence && !sequence->pending.empty())
+					{
+						std::vector<u8> pending;
+						{
+							std::lock_guard lock(cache->mutex);
+
+							// Only the most recent access units are replayed, the decoder state will no longer match the keys
+							if (sequence->truncated)
+							{
+								sequence->key = 0;
+							}
+
+							pending = cache->take_pending(*sequence);
+						}
+
+						for (usz pos = 0; pos + decoder.nbytes <= pending.size(); pos += decoder.nbytes)
+						{
+							std::memcpy(work_mem.get_ptr(), &pending[pos], decoder.nbytes);
+
+							if (avcodec_send_packet(decoder.ctx, decoder.packet) == 0)
+							{
+								avcodec_receive_frame(decoder.ctx, decoder.frame);
+							}
+						}
+					}
+
+					std::memcpy(work_mem.get_ptr(), au_start_addr, decoder.nbytes);
+					const int err = avcodec_send_packet(decoder.ctx, decoder.packet);
+
+					if (cache_key)
+					{
+						cache->misses++;
+						cache->decode_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+					}
+
+					return err;
+				}(); err)
 				{
 					// These errors should never occur
 					if (err == AVERROR(EAGAIN) || err == averror_eof || err == AVERROR(EINVAL) || err == AVERROR(ENOMEM))
@@ -486,6 +735,17 @@ void AtracXdecContext::exec(ppu_thread& ppu)
 				{
 					fmt::throw_exception("avcodec_receive_frame() failed (err=0x%x='%s')", err, utils::av_error_to_string(err));
 				}
+				else if (sequence && sequence->key)
+				{
+					cache->store(cache_key, decoder.frame, decoder.nch_in);
+					sequence->key = cache_key;
+				}
+
+				// The decoder state after an error is not reproducible from the keys
+				if (sequence && error != CELL_OK)
+				{
+					sequence->key = 0;
+				}
 
 				decoded_samples_num = decoder.frame->nb_samples;
 				ensure(decoded_samples_num == 0u || decoded_samples_num == ATXDEC_SAMPLES_PER_FRAME);
@@ -837,6 +1097,18 @@ error_code _CellAdecCoreOpClose_atracx(ppu_thread& ppu, vm::ptr<AtracXdecContext
 	vm::var<u64> thread_ret;
 	ensure(sys_ppu_thread_join(ppu, static_cast<u32>(handle->thread_id), +thread_ret) == CELL_OK);
 
+	if (g_cfg.audio.atracx_pcm_cache)
+	{
+		auto& cache = g_fxo->get<atracx_pcm_cache>();
+		std::lock_guard lock(cache.mutex);
+
+		if (const auto found = cache.sequences.find(handle->work_mem.addr()); found != cache.sequences.end())
+		{
+			cache.take_pending(found->second);
+			cache.sequences.erase(found);
+		}
+	}
+
 	error_code ret = sys_cond_destroy(ppu, handle->queue_not_empty);
 	ret = ret ? ret : sys_cond_destroy(ppu, handle->run_thread_cond);
 	ret = ret ? ret : sys_cond_destroy(ppu, handle->output_consumed);
@@ -7,6 +7,7 @@
 #include "Emu/Cell/Modules/cellAudioOut.h"
 #include "cellAudio.h"
 #include "util/video_provider.h"
+#include "util/simd.hpp"
 
 #include <cmath>
 
@@ -118,6 +119,8 @@ void cell_audio_config::reset(bool backend_changed)
 	time_stretching_enabled = raw_time_stretching_enabled;
 	time_stretching_threshold = raw.time_stretching_threshold / 100.0f;
 
+	adaptive_buffering = buffering_enabled && raw.adaptive_buffering;
+
 	// Warn if audio backend does not support all requested features
 	if (raw.buffering_enabled && !buffering_enabled)
 	{
@@ -154,7 +157,7 @@ audio_ringbuffer::audio_ringbuffer(cell_audio_config& _cfg)
 
 	// Configure resampler
 	resampler.set_params(static_cast<AudioChannelCnt>(cfg.audio_channels), static_cast<AudioFreq>(cfg.audio_sampling_rate));
-	resampler.set_tempo(RESAMPLER_MAX_FREQ_VAL);
+	resampler.set_tempo(RESAMPLER_MAX_FREQ_VAL, cfg.adaptive_buffering);
 
 	const f64 buffer_dur_mult = [&]()
 	{
@@ -179,11 +182,17 @@ audio_ringbuffer::~audio_ringbuffer()
 	}
 
 	backend->Close();
+
+	if (cfg.buffering_enabled && cb_count)
+	{
+		cellAudio.notice("Audio buffering: %u backend callbacks (period=%uus, jitter=%uus), %u underruns",
+			cb_count.load(), cb_period.load(), cb_jitter.load(), cb_underruns.load());
+	}
 }
 
 f32 audio_ringbuffer::set_frequency_ratio(f32 new_ratio)
 {
-	frequency_ratio = static_cast<f32>(resampler.set_tempo(new_ratio));
+	frequency_ratio = static_cast<f32>(resampler.set_tempo(new_ratio, cfg.adaptive_buffering));
 
 	return frequency_ratio;
 }
@@ -199,7 +208,44 @@ u32 audio_ringbuffer::backend_write_callback(u32 size, void *buf)
 {
 	if (!backend_active.observe()) backend_active = true;
 
-	return static_cast<u32>(cb_ringbuf.pop(buf, size, true));
+	// Smoothed mean and mean deviation of the callback interval (same estimator as TCP's RTT)
+	const u64 timestamp = get_timestamp();
+
+	if (cb_last_timestamp && timestamp > cb_last_timestamp)
+	{
+		const s64 interval = timestamp - cb_last_timestamp;
+
+		if (const s64 period = cb_period.load())
+		{
+			const s64 jitter = cb_jitter.load();
+			cb_jitter.release(jitter + (std::abs(interval - period) - jitter) / 4);
+			cb_period.release(period + (interval - period) / 8);
+		}
+		else
+		{
+			cb_period.release(interval);
+			cb_jitter.release(interval / 2);
+		}
+	}
+
+	cb_last_timestamp = timestamp;
+	cb_count++;
+
+	const u32 popped = static_cast<u32>(cb_ringbuf.pop(buf, size, true));
+
+	if (popped < size && cb_underrun_armed.observe())
+	{
+		// The ring ran dry during playback, don't count the drain after a flush
+		cb_underrun_armed.release(false);
+		cb_underruns++;
+
+		if (cfg.adaptive_buffering && underrun_headroom.observe() < cfg.desired_buffer_duration)
+		{
+			underrun_headroom += cfg.audio_block_period;
+		}
+	}
+
+	return popped;
 }
 
 void audio_ringbuffer::backend_state_callback(AudioStateEvent event)
@@ -240,6 +286,41 @@ u64 audio_ringbuffer::get_enqueued_playtime() const
 	return get_enqueued_samples() * 1'000'000 / cfg.audio_sampling_rate;
 }
 
+u64 audio_ringbuffer::get_desired_playtime() const
+{
+	if (!cfg.adaptive_buffering)
+	{
+		return cfg.desired_buffer_duration;
+	}
+
+	// One callback worth of data has to be ready when the backend asks for it, plus enough to cover its jitter.
+	// Until the backend has called us a few times, use the nominal callback length.
+	const u64 period = cb_count >= 8 ? cb_period.load() : static_cast<u64>(cfg.audio_min_buffer_duration * 1'000'000);
+	const u64 jitter = cb_count >= 8 ? cb_jitter.load() : 0;
+	const u64 desired = period + jitter * 4 + cfg.audio_block_period + underrun_headroom;
+
+	return std::clamp<u64>(desired, u64{cfg.audio_block_period} * 2, cfg.desired_buffer_duration);
+}
+
+audio_latency_stats audio_ringbuffer::get_latency_stats() const
+{
+	audio_latency_stats stats{};
+	stats.callbacks = cb_count;
+	stats.underruns = cb_underruns;
+	stats.callback_period = cb_period;
+	stats.callback_jitter = cb_jitter;
+	stats.frequency_ratio = frequency_ratio;
+	stats.time_stretching = cfg.time_stretching_enabled && resampler.is_time_stretching();
+
+	if (cfg.buffering_enabled)
+	{
+		stats.target_playtime = get_desired_playtime();
+		stats.enqueued_playtime = get_enqueued_playtime();
+	}
+
+	return stats;
+}
+
 void audio_ringbuffer::enqueue(bool enqueue_silence, bool force)
 {
 	AUDIT(cur_pos < cfg.num_allocated_buffers);
@@ -260,6 +341,15 @@ void audio_ringbuffer::enqueue(bool enqueue_silence, bool force)
 		return;
 	}
 
+	if (underrun_headroom.observe())
+	{
+		// Give back one block of headroom every 256 stable periods (~1.4s)
+		underrun_headroom.atomic_op([&](u64& headroom)
+		{
+			headroom -= std::min<u64>(headroom, cfg.audio_block_period / 256 + 1);
+		});
+	}
+
 	// Enqueue audio
 	if (cfg.time_stretching_enabled)
 	{
@@ -312,6 +402,7 @@ void audio_ringbuffer::commit_data(f32* buf, u32 sample_cnt)
 	}
 
 	cb_ringbuf.push(buf, sample_cnt_out * cfg.audio_sample_size);
+	cb_underrun_armed.release(true);
 }
 
 void audio_ringbuffer::play()
@@ -329,6 +420,7 @@ void audio_ringbuffer::play()
 void audio_ringbuffer::flush()
 {
 	backend->Pause();
+	cb_underrun_armed = false;
 	cb_ringbuf.writer_flush();
 	resampler.flush();
 	backend_active = false;
@@ -551,6 +643,8 @@ void cell_audio_thread::advance(u64 timestamp)
 		m_average_playtime = cfg.period_average_alpha * ringbuffer->get_enqueued_playtime() + (1.0f - cfg.period_average_alpha) * m_average_playtime;
 	}
 
+	m_latency_stats = ringbuffer->get_latency_stats();
+
 	m_counter++;
 	m_last_period_end = timestamp;
 	m_dynamic_period = 0;
@@ -614,6 +708,7 @@ namespace audio
 			.audio_device = g_cfg.audio.audio_device,
 			.buffering_enabled = static_cast<bool>(g_cfg.audio.enable_buffering),
 			.desired_buffer_duration = g_cfg.audio.desired_buffer_duration,
+			.adaptive_buffering = static_cast<bool>(g_cfg.audio.adaptive_buffering),
 			.enable_time_stretching = static_cast<bool>(g_cfg.audio.enable_time_stretching),
 			.time_stretching_threshold = g_cfg.audio.time_stretching_threshold,
 			.convert_to_s16 = static_cast<bool>(g_cfg.audio.convert_to_s16),
@@ -641,6 +736,7 @@ namespace audio
 				raw.audio_device != new_raw.audio_device ||
 				raw.desired_buffer_duration != new_raw.desired_buffer_duration ||
 				raw.buffering_enabled != new_raw.buffering_enabled ||
+				raw.adaptive_buffering != new_raw.adaptive_buffering ||
 				raw.time_stretching_threshold != new_raw.time_stretching_threshold ||
 				raw.enable_time_stretching != new_raw.enable_time_stretching ||
 				raw.convert_to_s16 != new_raw.convert_to_s16 ||
@@ -653,6 +749,26 @@ namespace audio
 			}
 		}
 	}
+
+	std::string format_latency_stats()
+	{
+		auto g_audio = g_fxo->try_get<cell_audio>();
+
+		if (!g_audio || g_cfg.audio.provider != audio_provider::cell_audio)
+		{
+			return "Inactive";
+		}
+
+		audio_latency_stats stats{};
+		{
+			reader_lock lock(g_audio->mutex);
+			stats = g_audio->m_latency_stats;
+		}
+
+		return fmt::format("%3ums buffered (target %ums), callback %ums +-%ums, %llu underruns, ratio %.3f%s",
+			stats.enqueued_playtime / 1000, stats.target_playtime / 1000, stats.callback_period / 1000, stats.callback_jitter / 1000,
+			stats.underruns, stats.frequency_ratio, stats.time_stretching ? " (stretching)" : "");
+	}
 }
 
 void cell_audio_thread::update_config(bool backend_changed)
@@ -766,7 +882,8 @@ void cell_audio_thread::operator()()
 			{
 				// Restart algorithm
 				cellAudio.trace("restarting audio");
-				ringbuffer->enqueue_silence(cfg.desired_full_buffers, true);
+				const u32 silence_buffers = cfg.adaptive_buffering ? static_cast<u32>(ringbuffer->get_desired_playtime() / cfg.audio_block_period) + 1 : cfg.desired_full_buffers;
+				ringbuffer->enqueue_silence(silence_buffers, true);
 				finish_port_volume_stepping();
 				m_average_playtime = static_cast<f32>(ringbuffer->get_enqueued_playtime());
 				untouched_expected = 0;
@@ -834,7 +951,7 @@ void cell_audio_thread::operator()()
 			const f32 average_playtime_ratio = m_average_playtime / cfg.audio_buffer_length;
 
 			// Use the above average ratio to decide how much buffer we should be aiming for
-			f32 desired_duration_adjusted = cfg.desired_buffer_duration + (cfg.audio_block_period / 2.0f);
+			f32 desired_duration_adjusted = ringbuffer->get_desired_playtime() + (cfg.audio_block_period / 2.0f);
 			if (average_playtime_ratio < 1.0f)
 			{
 				desired_duration_adjusted /= std::max(average_playtime_ratio, 0.25f);
@@ -853,8 +970,10 @@ void cell_audio_thread::operator()()
 					const f32 normalized_desired_duration_rate = desired_duration_rate / cfg.time_stretching_threshold;
 
 					// change frequency ratio in steps
+					// small corrections are cheap while they stay in the range of the linear resampler, so those can be finer
 					const f32 req_time_stretching_step = (normalized_desired_duration_rate + frequency_ratio) / 2.0f;
-					if (std::abs(req_time_stretching_step - frequency_ratio) > cfg.time_stretching_step)
+					const f32 min_step = cfg.adaptive_buffering && req_time_stretching_step >= RESAMPLER_LINEAR_MIN_FREQ_VAL ? cfg.linear_resampling_step : cfg.time_stretching_step;
+					if (std::abs(req_time_stretching_step - frequency_ratio) > min_step)
 					{
 						ringbuffer->set_frequency_ratio(req_time_stretching_step);
 					}
@@ -1033,6 +1152,86 @@ audio_port* cell_audio_thread::open_port()
 	return nullptr;
 }
 
+namespace
+{
+	// part of cellAudioSetPortLevel functionality
+	// Port volume changes are spread over 13ms. The ramp is linear, so the gain of every frame of the period is computed
+	// in one go instead of stepping the level (and reloading the atomic target) for each frame.
+	void compute_port_gains(audio_port& port, f32 master_volume, f32* gains)
+	{
+		const audio_port::level_set_t param = port.level_set.load();
+
+		if (param.inc == 0.0f)
+		{
+			std::fill_n(gains, AUDIO_BUFFER_SAMPLES, port.level * master_volume);
+			return;
+		}
+
+		// Frame i uses level + inc * (i + 1) until that value reaches the target, from then on the target is used
+		const f32 steps = std::ceil((param.value - port.level) / param.inc);
+		const u32 ramp_frames = steps <= 1.0f ? 0 : static_cast<u32>(std::min<f32>(steps, AUDIO_BUFFER_SAMPLES + 1)) - 1;
+		const f32 level = port.level;
+
+		for (u32 i = 0; i < ramp_frames; i++)
+		{
+			gains[i] = (level + param.inc * (i + 1)) * master_volume;
+		}
+
+		if (ramp_frames < AUDIO_BUFFER_SAMPLES)
+		{
+			std::fill_n(gains + ramp_frames, AUDIO_BUFFER_SAMPLES - ramp_frames, param.value * master_volume);
+
+			port.level = param.value;
+			port.level_set.compare_and_swap(param, { param.value, 0.0f });
+		}
+		else
+		{
+			port.level = level + param.inc * AUDIO_BUFFER_SAMPLES;
+		}
+	}
+
+	// Converts one period of interleaved big-endian samples to native floats and applies the per-frame gain
+	template <u32 in_channels>
+	void load_port_samples(const be_t<f32>* src, const f32* gains, f32* dst)
+	{
+		for (u32 frame = 0; frame < AUDIO_BUFFER_SAMPLES; frame += 4)
+		{
+			const v128 g = v128::loadu(gains + frame);
+			const auto in = src + frame * in_channels;
+			const auto out = dst + frame * in_channels;
+
+			if constexpr (in_channels == 2)
+			{
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 0)), gv_unpacklo32(g, g)), out, 0);
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 1)), gv_unpackhi32(g, g)), out, 1);
+			}
+			else
+			{
+				static_assert(in_channels == 8);
+
+				const v128 g0 = gv_shuffle32<0, 0, 0, 0>(g);
+				const v128 g1 = gv_shuffle32<1, 1, 1, 1>(g);
+				const v128 g2 = gv_shuffle32<2, 2, 2, 2>(g);
+				const v128 g3 = gv_shuffle32<3, 3, 3, 3>(g);
+
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 0)), g0), out, 0);
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 1)), g0), out, 1);
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 2)), g1), out, 2);
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 3)), g1), out, 3);
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 4)), g2), out, 4);
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 5)), g2), out, 5);
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 6)), g3), out, 6);
+				v128::storeu(gv_mulfs(gv_to_be32(v128::loadu(in, 7)), g3), out, 7);
+			}
+		}
+	}
+
+	void add_samples(f32* dst, const v128& value)
+	{
+		v128::storeu(gv_addfs(v128::loadu(dst), value), dst);
+	}
+}
+
 template <AudioChannelCnt channels, AudioChannelCnt downmix>
 void cell_audio_thread::mix(float* out_buffer, s32 offset)
 {
@@ -1046,116 +1245,86 @@ void cell_audio_thread::mix(float* out_buffer, s32 offset)
 	// Reset out_buffer
 	std::memset(out_buffer, 0, out_buffer_sz * sizeof(float));
 
+	alignas(16) f32 gains[AUDIO_BUFFER_SAMPLES];
+	alignas(16) f32 samples[8 * AUDIO_BUFFER_SAMPLES];
+
 	// mixing
 	for (audio_port& port : ports)
 	{
 		if (port.state != audio_port_state::started) continue;
 
-		auto buf = port.get_vm_ptr(offset);
+		const auto buf = port.get_vm_ptr(offset);
 
 		static constexpr float minus_3db = 0.707f; // value taken from https://www.dolby.com/us/en/technologies/a-guide-to-dolby-metadata.pdf
-		float m = master_volume;
 
-		// part of cellAudioSetPortLevel functionality
-		// spread port volume changes over 13ms
-		auto step_volume = [master_volume, &m](audio_port& port)
+		compute_port_gains(port, master_volume, gains);
+
+		if (port.num_channels == 2)
 		{
-			const audio_port::level_set_t param = port.level_set.load();
+			load_port_samples<2>(buf, gains, samples);
 
-			if (param.inc != 0.0f)
+			if constexpr (out_channels == 2)
 			{
-				port.level += param.inc;
-				const bool dec = param.inc < 0.0f;
-
-				if ((!dec && param.value - port.level <= 0.0f) || (dec && param.value - port.level >= 0.0f))
+				for (u32 i = 0; i < out_buffer_sz; i += 4)
 				{
-					port.level = param.value;
-					port.level_set.compare_and_swap(param, { param.value, 0.0f });
+					add_samples(out_buffer + i, v128::loadu(samples + i));
 				}
 			}
-
-			m = port.level * master_volume;
-		};
-
-		if (port.num_channels == 2)
-		{
-			for (u32 out = 0, in = 0; out < out_buffer_sz; out += out_channels, in += 2)
+			else
 			{
-				step_volume(port);
-
-				const float left  = buf[in + 0] * m;
-				const float right = buf[in + 1] * m;
-
-				out_buffer[out + 0] += left;
-				out_buffer[out + 1] += right;
+				for (u32 out = 0, in = 0; out < out_buffer_sz; out += out_channels, in += 2)
+				{
+					out_buffer[out + 0] += samples[in + 0];
+					out_buffer[out + 1] += samples[in + 1];
+				}
 			}
 		}
 		else if (port.num_channels == 8)
 		{
+			load_port_samples<8>(buf, gains, samples);
+
 			for (u32 out = 0, in = 0; out < out_buffer_sz; out += out_channels, in += 8)
 			{
-				step_volume(port);
+				const v128 front = v128::loadu(samples + in);    // left, right, center, low_freq
+				const v128 back = v128::loadu(samples + in + 4); // side_left, side_right, rear_left, rear_right
 
-				const float left       = buf[in + 0] * m;
-				const float right      = buf[in + 1] * m;
-				const float center     = buf[in + 2] * m;
-				const float low_freq   = buf[in + 3] * m;
-				const float side_left  = buf[in + 4] * m;
-				const float side_right = buf[in + 5] * m;
-				const float rear_left  = buf[in + 6] * m;
-				const float rear_right = buf[in + 7] * m;
+				// Lanes 0 and 1 hold side + rear for each side
+				const v128 side_rear = gv_addfs(back, gv_shuffle32<2, 3, 0, 1>(back));
 
 				if constexpr (downmix == AudioChannelCnt::STEREO)
 				{
 					// Don't mix in the lfe as per dolby specification and based on documentation
-					const float mid = center * 0.5f;
-					out_buffer[out + 0] += left * minus_3db + mid + side_left * 0.5f + rear_left * 0.5f;
-					out_buffer[out + 1] += right * minus_3db + mid + side_right * 0.5f + rear_right * 0.5f;
+					const v128 mid = gv_shuffle32<2, 2, 2, 2>(front);
+					const v128 mixed = gv_fmafs(front, gv_bcstfs(minus_3db), gv_mulfs(gv_addfs(mid, side_rear), 0.5f));
+					out_buffer[out + 0] += mixed._f[0];
+					out_buffer[out + 1] += mixed._f[1];
 				}
-				else if constexpr (downmix == AudioChannelCnt::SURROUND_5_1)
+				else if constexpr (out_channels == 2)
 				{
-					out_buffer[out + 0] += left;
-					out_buffer[out + 1] += right;
-
-					if constexpr (out_channels >= 6) // Only mix the surround channels into the output if surround output is configured
-					{
-						out_buffer[out + 2] += center;
-						out_buffer[out + 3] += low_freq;
-
-						if constexpr (out_channels == 6)
-						{
-							out_buffer[out + 4] += side_left + rear_left;
-							out_buffer[out + 5] += side_right + rear_right;
-						}
-						else // When using 7.1 ouput, out_buffer[out + 4] and out_buffer[out + 5] are the rear channels, so the side channels need to be mixed into [out + 6] and [out + 7]
-						{
-							out_buffer[out + 6] += side_left + rear_left;
-							out_buffer[out + 7] += side_right + rear_right;
-						}
-					}
+					out_buffer[out + 0] += front._f[0];
+					out_buffer[out + 1] += front._f[1];
 				}
 				else
 				{
-					out_buffer[out + 0] += left;
-					out_buffer[out + 1] += right;
+					// Only mix the surround channels into the output if surround output is configured
+					add_samples(out_buffer + out, front);
 
-					if constexpr (out_channels >= 6) // Only mix the surround channels into the output if surround output is configured
+					if constexpr (downmix == AudioChannelCnt::SURROUND_5_1)
+					{
+						// When using 7.1 ouput, out_buffer[out + 4] and out_buffer[out + 5] are the rear channels, so the side channels need to be mixed into [out + 6] and [out + 7]
+						constexpr u32 side_offset = out_channels == 6 ? 4 : 6;
+						out_buffer[out + side_offset + 0] += side_rear._f[0];
+						out_buffer[out + side_offset + 1] += side_rear._f[1];
+					}
+					else if constexpr (out_channels == 6)
+					{
+						out_buffer[out + 4] += back._f[0];
+						out_buffer[out + 5] += back._f[1];
+					}
+					else
 					{
-						out_buffer[out + 2] += center;
-						out_buffer[out + 3] += low_freq;
-
-						if constexpr (out_channels == 6)
-						{
-							out_buffer[out + 4] += side_left;
-							out_buffer[out + 5] += side_right;
-						}
-						else
-						{
-							out_buffer[out + 4] += rear_left;
-							out_buffer[out + 5] += rear_right;
-							out_buffer[out + 6] += side_left;
-							out_buffer[out + 7] += side_right;
-						}
+						// rear_left, rear_right, side_left, side_right
+						add_samples(out_buffer + out + 4, gv_shuffle32<2, 3, 0, 1>(back));
 					}
 				}
 			}
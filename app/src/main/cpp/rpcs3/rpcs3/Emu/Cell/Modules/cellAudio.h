@@ -208,6 +208,7 @@ struct cell_audio_config
 		std::string audio_device{};
 		bool buffering_enabled = false;
 		s64 desired_buffer_duration = 0;
+		bool adaptive_buffering = false;
 		bool enable_time_stretching = false;
 		s64 time_stretching_threshold = 0;
 		bool convert_to_s16 = false;
@@ -249,6 +250,10 @@ struct cell_audio_config
 	u32 desired_full_buffers = 0;
 	u32 num_allocated_buffers = 0; // number of ringbuffer buffers
 
+	// Size the buffer from the measured backend callback jitter instead of desired_buffer_duration,
+	// which then only acts as an upper bound
+	bool adaptive_buffering = false;
+
 	static constexpr f32 period_average_alpha = 0.02f; // alpha factor for the m_average_period rolling average
 
 	// when comparing the current period time with the desired period, if it is below this number of usecs we do not wait any longer(quantum dependent)
@@ -270,6 +275,7 @@ struct cell_audio_config
 
 	f32 time_stretching_threshold = 0.0f; // we only apply time stretching below this buffer fill rate (adjusted for average period)
 	static constexpr f32 time_stretching_step = 0.1f; // will only reduce/increase the frequency ratio in steps of at least this value
+	static constexpr f32 linear_resampling_step = 0.005f; // same as above while the ratio stays in the range of the linear resampler (adaptive buffering only)
 
 	/*
 	 * Constructor
@@ -282,6 +288,18 @@ struct cell_audio_config
 	void reset(bool backend_changed = true);
 };
 
+struct audio_latency_stats
+{
+	u64 callbacks = 0;
+	u64 underruns = 0;         // backend callbacks that could not be served completely
+	u64 callback_period = 0;   // smoothed interval between backend callbacks (usecs)
+	u64 callback_jitter = 0;   // smoothed mean deviation of the above (usecs)
+	u64 target_playtime = 0;   // buffer duration currently aimed for (usecs)
+	u64 enqueued_playtime = 0; // usecs
+	f32 frequency_ratio = 1.0f;
+	bool time_stretching = false;
+};
+
 class audio_ringbuffer
 {
 private:
@@ -311,6 +329,17 @@ private:
 
 	u32 cur_pos = 0;
 
+	// Backend callback timing, written by the backend thread
+	u64 cb_last_timestamp = 0;
+	atomic_t<u64> cb_period = 0;
+	atomic_t<u64> cb_jitter = 0;
+	atomic_t<u64> cb_count = 0;
+	atomic_t<u64> cb_underruns = 0;
+	atomic_t<bool> cb_underrun_armed = false;
+
+	// Extra buffer added after underruns, slowly given back while playback is stable
+	atomic_t<u64> underrun_headroom = 0;
+
 	bool get_backend_playing() const
 	{
 		return backend->IsPlaying();
@@ -338,6 +367,8 @@ public:
 
 	u64 get_enqueued_samples() const;
 	u64 get_enqueued_playtime() const;
+	u64 get_desired_playtime() const;
+	audio_latency_stats get_latency_stats() const;
 
 	bool is_playing() const
 	{
@@ -413,6 +444,7 @@ public:
 	f32 m_average_playtime = 0.0f;
 	bool m_backend_failed = false;
 	bool m_audio_should_restart = false;
+	audio_latency_stats m_latency_stats{}; // protected by mutex
 
 	void operator()();
 
@@ -433,4 +465,7 @@ namespace audio
 {
 	cell_audio_config::raw_config get_raw_config();
 	extern void configure_audio(bool force_reset = false);
+
+	// Buffering statistics of the cellAudio output, for tuning on devices with unsteady audio callbacks
+	std::string format_latency_stats();
 }
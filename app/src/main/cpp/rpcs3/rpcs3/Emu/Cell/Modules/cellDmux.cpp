@@ -95,6 +95,63 @@ struct DemuxerStream
 	}
 };
 
+// Offsets of the packet start codes in the rest of a stream chunk, collected in one pass the first time the parser loses sync.
+// Packet bodies are skipped using their length field, so payload bytes that look like start codes are not indexed.
+static std::vector<u32> index_packets(const DemuxerStream& stream)
+{
+	std::vector<u32> result;
+
+	if (stream.size < 4)
+	{
+		return result;
+	}
+
+	const u8* const base = vm::_ptr<u8>(stream.addr);
+	const u8* const end = base + stream.size;
+	const u8* ptr = base;
+
+	result.reserve(stream.size / 2048 * 3);
+
+	while (end - ptr >= 4)
+	{
+		const u8* found = static_cast<const u8*>(std::memchr(ptr, 0, end - ptr - 3));
+
+		if (!found)
+		{
+			break;
+		}
+
+		if (found[1] != 0 || found[2] != 1 || found[3] < 0xba)
+		{
+			ptr = found + 1;
+			continue;
+		}
+
+		result.push_back(static_cast<u32>(found - base));
+
+		usz size = 4;
+
+		switch (0x100u | found[3])
+		{
+		case PACK_START_CODE: size = 14; break;
+		case SYSTEM_HEADER_START_CODE: size = 18; break;
+		default:
+		{
+			if (end - found >= 6)
+			{
+				size = 6 + ((u32{found[4]} << 8) | found[5]);
+			}
+
+			break;
+		}
+		}
+
+		ptr = found + std::min<usz>(size, end - found);
+	}
+
+	return result;
+}
+
 struct PesHeader
 {
 	u64 pts;
@@ -225,6 +282,10 @@ public:
 	{
 		DemuxerTask task;
 		DemuxerStream stream = {};
+		u32 stream_base = 0;
+		std::vector<u32> packets; // Start code offsets relative to stream_base
+		usz packet_pos = 0;
+		bool packets_indexed = false; // Built on the first resync, well-formed streams never need it
 		ElementaryStream* esALL[96]{};
 		ElementaryStream** esAVC = &esALL[0]; // AVC (max 16 minus M2V count)
 		//ElementaryStream** esM2V = &esALL[16]; // M2V (max 16 minus AVC count)
@@ -508,8 +569,23 @@ public:
 						fmt::throw_exception("Unknown code found (0x%x)", code);
 					}
 
-					// search
-					stream.skip(1);
+					// Resync at the next indexed packet instead of searching byte by byte
+					if (!packets_indexed || stream.addr < stream_base)
+					{
+						stream_base = stream.addr;
+						packets = index_packets(stream);
+						packet_pos = 0;
+						packets_indexed = true;
+					}
+
+					const u32 pos = stream.addr - stream_base;
+
+					while (packet_pos < packets.size() && packets[packet_pos] <= pos)
+					{
+						packet_pos++;
+					}
+
+					stream.skip(packet_pos < packets.size() ? packets[packet_pos] - pos : stream.size);
 				}
 				}
 
@@ -539,6 +615,8 @@ public:
 				}
 
 				stream = task.stream;
+				packets.clear();
+				packets_indexed = false;
 				//cellDmux.notice("*** stream updated(addr=0x%x, size=0x%x, discont=%d, userdata=0x%llx)",
 					//stream.addr, stream.size, stream.discontinuity, stream.userdata);
 				break;
@@ -1,13 +1,21 @@
 #include "stdafx.h"
 #include "Emu/VFS.h"
 #include "Emu/IdManager.h"
+#include "Emu/System.h"
 #include "Emu/Cell/PPUModule.h"
 
 #include "Emu/Cell/lv2/sys_fs.h"
+#include "Emu/Cell/lv2/sys_ppu_thread.h"
 #include "Emu/Cell/lv2/sys_sync.h"
+#include "Utilities/lockless.h"
+#include "util/sysinfo.hpp"
+#include "sysPrxForUser.h"
 #include "cellFs.h"
 
+#include <deque>
 #include <mutex>
+#include <set>
+#include <unordered_map>
 
 LOG_CHANNEL(cellFs);
 
@@ -890,130 +898,408 @@ s32 cellFsStReadWaitCallback(u32 fd, u64 size, vm::ptr<void(s32 xfd, u64 xsize)>
 
 using fs_aio_cb_t = vm::ptr<void(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)>;
 
-struct fs_aio_thread : ppu_thread
+struct fs_aio_request
 {
-	using ppu_thread::ppu_thread;
+	u32 type; // 1 = read, 2 = write
+	s32 xid;
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
 
-	void non_task()
+	// Control block contents at submission
+	u64 offset;
+	vm::ptr<void> buf;
+	u64 size;
+
+	s32 error = CELL_EBADF;
+	u64 result = 0;
+	bool cancelled = false;
+};
+
+// Host side AIO engine. Requests are queued per file descriptor and serviced by a pool of worker threads with positional I/O,
+// so different files proceed in parallel. A descriptor is only ever owned by one worker at a time, which keeps completions
+// in submission order per file. Guest callbacks are issued from a single HLE PPU thread.
+// Workers access guest memory from the host, so they hold off while emulation is paused and are joined with the other
+// emulation threads before a savestate is written.
+struct fs_aio_manager
+{
+	// Adjacent reads are merged into a single host read up to this size
+	static constexpr u64 max_coalesced_size = 0x100000;
+
+	struct file_queue
+	{
+		std::deque<fs_aio_request> requests;
+		bool busy = false; // Owned by a worker
+	};
+
+	shared_mutex mutex;
+	std::unordered_map<u32, file_queue> files;
+	std::deque<u32> ready; // Descriptors with queued requests and no owner
+	std::set<std::string> mount_points;
+	atomic_t<u32> work_signal = 0;
+
+	lf_queue<fs_aio_request> completed;
+
+	atomic_t<u32> callback_thread = 0; // Published once the thread has been created
+	bool callback_thread_claimed = false;
+	std::unique_ptr<named_thread_group<std::function<void()>>> workers;
+
+	// Returns false if the thread is being aborted
+	static bool wait_for_emulation()
+	{
+		while (Emu.IsPausedOrReady())
+		{
+			if (thread_ctrl::state() == thread_state::aborting)
+			{
+				return false;
+			}
+
+			thread_ctrl::wait_for(10000);
+		}
+
+		return thread_ctrl::state() != thread_state::aborting;
+	}
+
+	void submit(fs_aio_request&& req, u32 fd)
 	{
-		while (cmd64 cmd = cmd_wait())
 		{
-			const u32 type = cmd.arg1<u32>();
-			const s32 xid = cmd.arg2<s32>();
-			const cmd64 cmd2 = cmd_get(1);
-			const auto aio = cmd2.arg1<vm::ptr<CellFsAio>>();
-			const auto func = cmd2.arg2<fs_aio_cb_t>();
-			cmd_pop(1);
+			std::lock_guard lock(mutex);
+
+			auto& queue = files[fd];
+			queue.requests.emplace_back(std::move(req));
+
+			if (queue.busy || queue.requests.size() > 1)
+			{
+				// Already owned by a worker or listed as ready
+				return;
+			}
+
+			ready.push_back(fd);
+		}
+
+		work_signal++;
+		work_signal.notify_one();
+	}
+
+	static void process(u32 fd, std::deque<fs_aio_request>& batch)
+	{
+		const auto file = idm::get_unlocked<lv2_fs_object, lv2_file>(fd);
+
+		std::vector<u8> coalesced;
+
+		for (usz i = 0; i < batch.size();)
+		{
+			fs_aio_request& req = batch[i];
+
+			if (!wait_for_emulation())
+			{
+				// Completions are not going to be delivered anymore
+				return;
+			}
+
+			if (req.cancelled)
+			{
+				req.error = CELL_ECANCELED;
+				i++;
+				continue;
+			}
+
+			if (!file || (req.type == 1 && file->flags & CELL_FS_O_WRONLY) || (req.type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+			{
+				req.error = CELL_EBADF;
+				i++;
+				continue;
+			}
+
+			if (req.type == 2)
+			{
+				if (std::lock_guard lock(file->mutex); file->file)
+				{
+					const auto old_pos = file->file.pos(); file->file.seek(req.offset);
+					req.result = file->op_write(req.buf, req.size);
+					file->file.seek(old_pos);
+					req.error = CELL_OK;
+				}
+
+				i++;
+				continue;
+			}
 
-			s32 error = CELL_EBADF;
-			u64 result = 0;
+			// Find following reads that continue where this one ends
+			usz end = i + 1;
+			u64 total = req.size;
 
-			const auto file = idm::get_unlocked<lv2_fs_object, lv2_file>(aio->fd);
+			while (end < batch.size() && batch[end].type == 1 && !batch[end].cancelled && batch[end].offset == req.offset + total && total + batch[end].size <= max_coalesced_size)
+			{
+				total += batch[end++].size;
+			}
+
+			reader_lock lock(file->mutex);
+
+			if (!file->file)
+			{
+				i++;
+				continue;
+			}
 
-			if (!file || (type == 1 && file->flags & CELL_FS_O_WRONLY) || (type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+			if (end == i + 1)
 			{
+				req.result = file->op_read(req.buf, req.size, req.offset);
+				req.error = CELL_OK;
+				i++;
+				continue;
 			}
-			else if (std::lock_guard lock(file->mp->mutex); file->file)
+
+			coalesced.resize(total);
+			const u64 nread = file->file.read_at(req.offset, coalesced.data(), total);
+
+			for (u64 pos = 0; i < end; pos += batch[i++].size)
+			{
+				const u64 part = pos < nread ? std::min(batch[i].size, nread - pos) : 0;
+				std::memcpy(batch[i].buf.get_ptr(), coalesced.data() + pos, part);
+				batch[i].result = part;
+				batch[i].error = CELL_OK;
+			}
+		}
+	}
+
+	void worker()
+	{
+		while (wait_for_emulation())
+		{
+			const u32 signal = work_signal;
+
+			u32 fd = 0;
+			std::deque<fs_aio_request> batch;
 			{
-				const auto old_pos = file->file.pos(); file->file.seek(aio->offset);
+				std::lock_guard lock(mutex);
 
-				result = type == 2
-					? file->op_write(aio->buf, aio->size)
-					: file->op_read(aio->buf, aio->size);
+				if (!ready.empty())
+				{
+					fd = ready.front();
+					ready.pop_front();
 
-				file->file.seek(old_pos);
-				error = CELL_OK;
+					auto& queue = files[fd];
+					queue.busy = true;
+					batch.swap(queue.requests);
+				}
 			}
 
-			func(*this, aio, error, xid, result);
-			lv2_obj::sleep(*this);
+			if (batch.empty())
+			{
+				thread_ctrl::wait_on(work_signal, signal);
+				continue;
+			}
+
+			process(fd, batch);
+
+			for (auto& req : batch)
+			{
+				completed.push(std::move(req));
+			}
+
+			std::lock_guard lock(mutex);
+
+			if (auto found = files.find(fd); found->second.requests.empty())
+			{
+				files.erase(found);
+			}
+			else
+			{
+				// More requests arrived meanwhile, let any worker pick them up after other files
+				found->second.busy = false;
+				ready.push_back(fd);
+				work_signal++;
+				work_signal.notify_one();
+			}
 		}
 	}
-};
 
-struct fs_aio_manager
-{
-	std::shared_ptr<fs_aio_thread> thread;
+	bool cancel(s32 xid)
+	{
+		std::lock_guard lock(mutex);
 
-	shared_mutex mutex;
+		for (auto& [fd, queue] : files)
+		{
+			for (auto& req : queue.requests)
+			{
+				if (req.xid == xid && !req.cancelled)
+				{
+					// Still completed in order, through its own callback
+					req.cancelled = true;
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	fs_aio_manager& operator=(thread_state state) noexcept
+	{
+		if (state == thread_state::aborting)
+		{
+			std::lock_guard lock(mutex);
+
+			if (workers)
+			{
+				for (auto& worker : *workers)
+				{
+					worker = thread_state::aborting;
+				}
+			}
+		}
+		else if (state == thread_state::finished)
+		{
+			std::unique_ptr<named_thread_group<std::function<void()>>> joined;
+			{
+				std::lock_guard lock(mutex);
+				joined = std::move(workers);
+			}
+
+			// Join outside of the lock, workers take it between batches
+			joined.reset();
+		}
+
+		return *this;
+	}
+
+	~fs_aio_manager()
+	{
+		workers.reset();
+	}
 };
 
-s32 cellFsAioInit(vm::cptr<char> mount_point)
+void fsAioEntry(ppu_thread& ppu)
 {
-	cellFs.warning("cellFsAioInit(mount_point=%s)", mount_point);
+	auto& m = g_fxo->get<fs_aio_manager>();
 
-	// TODO: create AIO thread (if not exists) for specified mount point
-	cellFs.fatal("cellFsAio disabled, use LLE.");
+	while (thread_ctrl::state() != thread_state::aborting)
+	{
+		for (auto&& req : m.completed.pop_all())
+		{
+			req.func(ppu, req.aio, req.error, req.xid, req.result);
+			lv2_obj::sleep(ppu);
+		}
 
-	return CELL_OK;
+		thread_ctrl::wait_on(m.completed);
+	}
+
+	ppu.state += cpu_flag::exit;
 }
 
-s32 cellFsAioFinish(vm::cptr<char> mount_point)
+s32 cellFsAioInit(ppu_thread& ppu, vm::cptr<char> mount_point)
 {
-	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
+	cellFs.warning("cellFsAioInit(mount_point=%s)", mount_point);
 
-	// TODO: delete existing AIO thread for specified mount point
+	auto& m = g_fxo->get<fs_aio_manager>();
 
-	return CELL_OK;
-}
+	bool create_thread = false;
+	{
+		std::lock_guard lock(m.mutex);
 
-atomic_t<s32> g_fs_aio_id;
+		if (m.mount_points.size() >= CELL_FS_AIO_MAX_FS)
+		{
+			return CELL_EMFILE;
+		}
 
-s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
-{
-	cellFs.warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+		m.mount_points.emplace(mount_point.get_ptr());
 
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+		if (!m.workers)
+		{
+			m.workers = std::make_unique<named_thread_group<std::function<void()>>>("FS AIO Worker ", std::clamp(utils::get_thread_count() / 2, 2u, 4u), [&m]() { m.worker(); });
+		}
 
-	auto& m = g_fxo->get<fs_aio_manager>();
+		create_thread = !std::exchange(m.callback_thread_claimed, true);
+	}
 
-	if (!m.thread)
+	if (!create_thread)
 	{
-		return CELL_ENXIO;
+		// Another thread is creating it, requests can't be submitted before it is published
+		while (!m.callback_thread && thread_ctrl::state() != thread_state::aborting)
+		{
+			thread_ctrl::wait_on(m.callback_thread, 0);
+		}
+
+		return CELL_OK;
 	}
 
-	const s32 xid = (*id = ++g_fs_aio_id);
+	// Created without the manager lock held, sys_ppu_thread_create may block and workers need the lock meanwhile
+	vm::var<u64> _tid;
+	vm::var<char[]> _name = vm::make_str("HLE FS AIO");
+	ppu_execute<&sys_ppu_thread_create>(ppu, +_tid, 0x10000, 0, 1001, 0x4000, SYS_PPU_THREAD_CREATE_INTERRUPT, +_name);
+
+	const u32 tid = static_cast<u32>(*_tid);
+	const auto thrd = idm::get_unlocked<named_thread<ppu_thread>>(tid);
 
-	m.thread->cmd_list
+	thrd->cmd_list
 	({
-		{ 1, xid },
-		{ aio, func },
+		{ ppu_cmd::hle_call, FIND_FUNC(fsAioEntry) },
 	});
 
+	thrd->state -= cpu_flag::stop;
+	thrd->state.notify_one();
+
+	m.callback_thread = tid;
+	m.callback_thread.notify_all();
+
 	return CELL_OK;
 }
 
-s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+s32 cellFsAioFinish(vm::cptr<char> mount_point)
 {
-	cellFs.warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+	cellFs.warning("cellFsAioFinish(mount_point=%s)", mount_point);
+
+	auto& m = g_fxo->get<fs_aio_manager>();
 
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+	std::lock_guard lock(m.mutex);
 
+	// The engine itself is shared and stays alive, pending requests still complete
+	if (!m.mount_points.erase(mount_point.get_ptr()))
+	{
+		return CELL_EINVAL;
+	}
+
+	return CELL_OK;
+}
+
+atomic_t<s32> g_fs_aio_id;
+
+template <u32 Type>
+static s32 fs_aio_submit(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
 	auto& m = g_fxo->get<fs_aio_manager>();
 
-	if (!m.thread)
+	if (!m.callback_thread)
 	{
 		return CELL_ENXIO;
 	}
 
 	const s32 xid = (*id = ++g_fs_aio_id);
 
-	m.thread->cmd_list
-	({
-		{ 2, xid },
-		{ aio, func },
-	});
-
+	m.submit({ Type, xid, aio, func, aio->offset, aio->buf, aio->size }, aio->fd);
 	return CELL_OK;
 }
 
-s32 cellFsAioCancel(s32 id)
+s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 {
-	cellFs.todo("cellFsAioCancel(id=%d) -> CELL_EINVAL", id);
+	cellFs.trace("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
 
-	// TODO: cancelled requests return CELL_ECANCELED through their own callbacks
+	return fs_aio_submit<1>(aio, id, func);
+}
+
+s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.trace("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+
+	return fs_aio_submit<2>(aio, id, func);
+}
 
-	return CELL_EINVAL;
+s32 cellFsAioCancel(s32 id)
+{
+	cellFs.warning("cellFsAioCancel(id=%d)", id);
+
+	// Requests already being serviced can no longer be cancelled
+	return g_fxo->get<fs_aio_manager>().cancel(id) ? CELL_OK : CELL_EINVAL;
 }
 
 s32 cellFsArcadeHddSerialNumber()
@@ -1116,4 +1402,6 @@ DECLARE(ppu_module_manager::cellFs)("sys_fs", []()
 	REG_FUNC(sys_fs, cellFsUtime);
 	REG_FUNC(sys_fs, cellFsWrite).flag(MFF_PERFECT);
 	REG_FUNC(sys_fs, cellFsWriteWithOffset);
+
+	REG_HIDDEN_FUNC(fsAioEntry);
 });
@@ -489,30 +489,35 @@ error_code cellGifDecDecodeData(vm::ptr<GifDecoder> mainHandle, vm::cptr<GifStre
 	const u64 fileSize = subHandle->fileSize;
 	const CellGifDecOutParam& current_outParam = subHandle->outParam;
 
-	//Copy the GIF file to a buffer
-	std::unique_ptr<u8[]> gif(new u8[fileSize]);
+	// Buffer sources are decoded in place, only file sources need a host copy
+	std::vector<u8> file_data;
+	const u8* gif = nullptr;
 
 	switch (subHandle->src.srcSelect)
 	{
 	case CELL_GIFDEC_BUFFER:
-		std::memcpy(gif.get(), subHandle->src.streamPtr.get_ptr(), fileSize);
+		gif = static_cast<const u8*>(subHandle->src.streamPtr.get_ptr());
 		break;
 
 	case CELL_GIFDEC_FILE:
 	{
 		auto file = idm::get_unlocked<lv2_fs_object, lv2_file>(fd);
-		file->file.seek(0);
-		file->file.read(gif.get(), fileSize);
+		file_data.resize(fileSize);
+		file->file.read_at(0, file_data.data(), fileSize);
+		gif = file_data.data();
 		break;
 	}
 	default: break; // TODO
 	}
 
+	if (!gif)
+		return CELL_GIFDEC_ERROR_STREAM_FORMAT;
+
 	//Decode GIF file. (TODO: Is there any faster alternative? Can we do it without external libraries?)
 	int width, height, actual_components;
 	auto image = std::unique_ptr<unsigned char,decltype(&::free)>
 		(
-			stbi_load_from_memory(gif.get(), ::narrow<int>(fileSize), &width, &height, &actual_components, 4),
+			stbi_load_from_memory(gif, ::narrow<int>(fileSize), &width, &height, &actual_components, 4),
 			&::free
 		);
 
@@ -10,6 +10,7 @@
 #include "cellJpgDec.h"
 
 #include "util/asm.hpp"
+#include "util/yuv_convert.hpp"
 
 LOG_CHANNEL(cellJpgDec);
 
@@ -40,6 +41,31 @@ void fmt_class_string<CellJpgDecError>::format(std::string& out, u64 arg)
 	});
 }
 
+// Returns the compressed stream. Buffer sources are used in place, files are read once and kept until the sub handle is closed.
+static std::span<const u8> get_jpg_stream(CellJpgDecSubHandle& handle)
+{
+	switch (handle.src.srcSelect)
+	{
+	case CELL_JPGDEC_BUFFER:
+		return { static_cast<const u8*>(vm::base(handle.src.streamPtr)), handle.fileSize };
+
+	case CELL_JPGDEC_FILE:
+	{
+		if (handle.file_data.empty())
+		{
+			if (auto file = idm::get_unlocked<lv2_fs_object, lv2_file>(handle.fd))
+			{
+				handle.file_data.resize(handle.fileSize);
+				handle.file_data.resize(file->file.read_at(0, handle.file_data.data(), handle.file_data.size()));
+			}
+		}
+
+		return handle.file_data;
+	}
+	default: return {}; // TODO
+	}
+}
+
 error_code cellJpgDecCreate(u32 mainHandle, u32 threadInParam, u32 threadOutParam)
 {
 	UNIMPLEMENTED_FUNC(cellJpgDec);
@@ -127,31 +153,14 @@ error_code cellJpgDecReadHeader(u32 mainHandle, u32 subHandle, vm::ptr<CellJpgDe
 		return CELL_JPGDEC_ERROR_FATAL;
 	}
 
-	const u32& fd = subHandle_data->fd;
-	const u64& fileSize = subHandle_data->fileSize;
 	CellJpgDecInfo& current_info = subHandle_data->info;
 
-	// Write the header to buffer
-	std::unique_ptr<u8[]> buffer(new u8[fileSize]);
+	const auto buffer = get_jpg_stream(*subHandle_data);
+	const usz fileSize = buffer.size();
 
-	switch (subHandle_data->src.srcSelect)
-	{
-	case CELL_JPGDEC_BUFFER:
-		std::memcpy(buffer.get(), vm::base(subHandle_data->src.streamPtr), fileSize);
-		break;
-
-	case CELL_JPGDEC_FILE:
-	{
-		auto file = idm::get_unlocked<lv2_fs_object, lv2_file>(fd);
-		file->file.seek(0);
-		file->file.read(buffer.get(), fileSize);
-		break;
-	}
-	default: break; // TODO
-	}
-
-	if (read_from_ptr<le_t<u32>>(buffer.get() + 0) != 0xE0FFD8FF || // Error: Not a valid SOI header
-		read_from_ptr<u32>(buffer.get() + 6) != "JFIF"_u32)   // Error: Not a valid JFIF string
+	if (fileSize < 10 ||
+		read_from_ptr<le_t<u32>>(buffer.data() + 0) != 0xE0FFD8FF || // Error: Not a valid SOI header
+		read_from_ptr<u32>(buffer.data() + 6) != "JFIF"_u32)   // Error: Not a valid JFIF string
 	{
 		return CELL_JPGDEC_ERROR_HEADER;
 	}
@@ -166,7 +175,7 @@ error_code cellJpgDecReadHeader(u32 mainHandle, u32 subHandle, vm::ptr<CellJpgDe
 	while(true)
 	{
 		i += block_length;                                  // Increase the file index to get to the next block
-		if (i >= fileSize ||                                // Check to protect against segmentation faults
+		if (i + 9 > fileSize ||                             // Check to protect against segmentation faults
 			buffer[i] != 0xFF)                              // Check that we are truly at the start of another block
 		{
 			return CELL_JPGDEC_ERROR_HEADER;
@@ -208,34 +217,20 @@ error_code cellJpgDecDecodeData(u32 mainHandle, u32 subHandle, vm::ptr<u8> data,
 		return CELL_JPGDEC_ERROR_FATAL;
 	}
 
-	const u32& fd = subHandle_data->fd;
-	const u64& fileSize = subHandle_data->fileSize;
 	const CellJpgDecOutParam& current_outParam = subHandle_data->outParam;
 
-	//Copy the JPG file to a buffer
-	std::unique_ptr<u8[]> jpg(new u8[fileSize]);
+	const auto jpg = get_jpg_stream(*subHandle_data);
 
-	switch (subHandle_data->src.srcSelect)
-	{
-	case CELL_JPGDEC_BUFFER:
-		std::memcpy(jpg.get(), vm::base(subHandle_data->src.streamPtr), fileSize);
-		break;
-
-	case CELL_JPGDEC_FILE:
-	{
-		auto file = idm::get_unlocked<lv2_fs_object, lv2_file>(fd);
-		file->file.seek(0);
-		file->file.read(jpg.get(), fileSize);
-		break;
-	}
-	default: break; // TODO
-	}
+	// Let stb_image produce the final component count, so that RGB and grayscale rows can be copied as is
+	const int decode_components =
+		current_outParam.outputColorSpace == CELL_JPG_RGB ? 3 :
+		current_outParam.outputColorSpace == CELL_JPG_GRAYSCALE ? 1 : 4;
 
 	//Decode JPG file. (TODO: Is there any faster alternative? Can we do it without external libraries?)
 	int width, height, actual_components;
 	auto image = std::unique_ptr<unsigned char,decltype(&::free)>
 		(
-			stbi_load_from_memory(jpg.get(), ::narrow<int>(fileSize), &width, &height, &actual_components, 4),
+			stbi_load_from_memory(jpg.data(), ::narrow<int>(jpg.size()), &width, &height, &actual_components, decode_components),
 			&::free
 		);
 
@@ -248,69 +243,40 @@ error_code cellJpgDecDecodeData(u32 mainHandle, u32 subHandle, vm::ptr<u8> data,
 
 	switch(current_outParam.outputColorSpace)
 	{
+	case CELL_JPG_GRAYSCALE:
 	case CELL_JPG_RGB:
 	case CELL_JPG_RGBA:
+	case CELL_JPG_ARGB:
 	{
-		const char nComponents = current_outParam.outputColorSpace == CELL_JPG_RGBA ? 4 : 3;
+		const int nComponents = decode_components;
 		image_size *= nComponents;
-		if (bytesPerLine > width * nComponents || flip) //check if we need padding
-		{
-			const int linesize = std::min(bytesPerLine, width * nComponents);
-			for (int i = 0; i < height; i++)
-			{
-				const int dstOffset = i * bytesPerLine;
-				const int srcOffset = width * nComponents * (flip ? height - i - 1 : i);
-				memcpy(&data[dstOffset], &image.get()[srcOffset], linesize);
-			}
-		}
-		else
+
+		const int pitch = (bytesPerLine > width * nComponents || flip) ? bytesPerLine : width * nComponents;
+		const usz row_bytes = std::min(pitch, width * nComponents);
+
+		if (pitch == width * nComponents && !flip && current_outParam.outputColorSpace != CELL_JPG_ARGB)
 		{
-			memcpy(data.get_ptr(), image.get(), image_size);
+			std::memcpy(data.get_ptr(), image.get(), image_size);
+			break;
 		}
-	}
-	break;
 
-	case CELL_JPG_ARGB:
-	{
-		const int nComponents = 4;
-		image_size *= nComponents;
-		if (bytesPerLine > width * nComponents || flip) //check if we need padding
+		for (int i = 0; i < height; i++)
 		{
-			//TODO: Find out if we can't do padding without an extra copy
-			const int linesize = std::min(bytesPerLine, width * nComponents);
-			const auto output = std::make_unique<char[]>(linesize);
-			for (int i = 0; i < height; i++)
+			const u8* src = image.get() + usz{static_cast<u32>(nComponents)} * width * (flip ? height - i - 1 : i);
+			u8* dst = &data[i * pitch];
+
+			if (current_outParam.outputColorSpace == CELL_JPG_ARGB)
 			{
-				const int dstOffset = i * bytesPerLine;
-				const int srcOffset = width * nComponents * (flip ? height - i - 1 : i);
-				for (int j = 0; j < linesize; j += nComponents)
-				{
-					output[j + 0] = image.get()[srcOffset + j + 3];
-					output[j + 1] = image.get()[srcOffset + j + 0];
-					output[j + 2] = image.get()[srcOffset + j + 1];
-					output[j + 3] = image.get()[srcOffset + j + 2];
-				}
-				std::memcpy(&data[dstOffset], output.get(), linesize);
+				utils::rgba32_to_argb32(src, dst, row_bytes / 4);
 			}
-		}
-		else
-		{
-			const auto img = std::make_unique<uint[]>(image_size);
-			uint* source_current = reinterpret_cast<uint*>(image.get());
-			uint* dest_current = img.get();
-			for (uint i = 0; i < image_size / nComponents; i++)
+			else
 			{
-				uint val = *source_current;
-				*dest_current = (val >> 24) | (val << 8); // set alpha (A8) as leftmost byte
-				source_current++;
-				dest_current++;
+				std::memcpy(dst, src, row_bytes);
 			}
-			std::memcpy(data.get_ptr(), img.get(), image_size);
 		}
 	}
 	break;
 
-	case CELL_JPG_GRAYSCALE:
 	case CELL_JPG_YCbCr:
 	case CELL_JPG_UPSAMPLE_ONLY:
 	case CELL_JPG_GRAYSCALE_TO_ALPHA_RGBA:
@@ -117,4 +117,5 @@ struct CellJpgDecSubHandle
 	CellJpgDecInfo info;
 	CellJpgDecOutParam outParam;
 	CellJpgDecSrc src;
+	std::vector<u8> file_data; // Contents of file sources, shared by ReadHeader and DecodeData
 };
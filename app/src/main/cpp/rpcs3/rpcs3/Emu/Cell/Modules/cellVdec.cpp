@@ -6,6 +6,7 @@
 #include "Emu/Cell/lv2/sys_ppu_thread.h"
 #include "Emu/Cell/lv2/sys_process.h"
 #include "Emu/savestate_utils.hpp"
+#include "Emu/system_config.h"
 #include "sysPrxForUser.h"
 #include "util/media_utils.h"
 
@@ -20,8 +21,8 @@
 extern "C"
 {
 #include "libavcodec/avcodec.h"
+#include "libavutil/hwcontext.h"
 #include "libavutil/imgutils.h"
-#include "libswscale/swscale.h"
 }
 #ifdef _MSC_VER
 #pragma warning(pop)
@@ -38,6 +39,8 @@ extern "C"
 #include "Utilities/lockless.h"
 #include <variant>
 #include "util/asm.hpp"
+#include "util/sysinfo.hpp"
+#include "util/yuv_convert.hpp"
 
 std::mutex g_mutex_avcodec_open2;
 
@@ -187,7 +190,8 @@ struct vdec_context final
 	const AVCodec* codec{};
 	const AVCodecDescriptor* codec_desc{};
 	AVCodecContext* ctx{};
-	SwsContext* sws{};
+	AVBufferRef* hw_device{};
+	AVPixelFormat hw_pix_fmt = AV_PIX_FMT_NONE;
 
 	shared_mutex mutex; // Used for 'out' queue (TODO)
 
@@ -211,6 +215,7 @@ struct vdec_context final
 	lf_queue<vdec_cmd> in_cmd;
 
 	AVRational log_time_base{}; // Used to reduce log spam
+	u64 last_au_usrd{}; // Userdata for pictures that are only returned at the end of the sequence
 
 	vdec_context(s32 type, u32 /*profile*/, u32 addr, u32 size, vm::ptr<CellVdecCbMsg> func, u32 arg)
 		: type(type)
@@ -261,6 +266,13 @@ struct vdec_context final
 			fmt::throw_exception("avcodec_alloc_context3() failed (type=0x%x)", type);
 		}
 
+		configure_threading();
+
+		if (g_cfg.core.vdec_hwaccel)
+		{
+			configure_hwaccel();
+		}
+
 		AVDictionary* opts = nullptr;
 
 		std::lock_guard lock(g_mutex_avcodec_open2);
@@ -269,6 +281,7 @@ struct vdec_context final
 		if (err || opts)
 		{
 			avcodec_free_context(&ctx);
+			av_buffer_unref(&hw_device);
 			std::string dict_content;
 			if (opts)
 			{
@@ -289,7 +302,286 @@ struct vdec_context final
 	~vdec_context()
 	{
 		avcodec_free_context(&ctx);
-		sws_freeContext(sws);
+		av_buffer_unref(&hw_device);
+	}
+
+	void configure_threading()
+	{
+		// Slice threading splits each picture and adds no delay. Frame threading decodes several pictures in parallel,
+		// which scales much better with H.264, but pictures only come out once the pipeline is full.
+		const u32 threads = g_cfg.core.vdec_threads ? g_cfg.core.vdec_threads.get() : std::clamp<u32>(utils::get_thread_count() / 2, 1, 4);
+
+		ctx->thread_count = threads;
+		ctx->thread_type = FF_THREAD_SLICE;
+
+		if (threads > 1 && g_cfg.core.vdec_frame_threading)
+		{
+			ctx->thread_type |= FF_THREAD_FRAME;
+		}
+	}
+
+	void configure_hwaccel()
+	{
+		for (int i = 0;; i++)
+		{
+			const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+
+			if (!config)
+			{
+				break;
+			}
+
+			if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX))
+			{
+				continue;
+			}
+
+			if (const int ret = av_hwdevice_ctx_create(&hw_device, config->device_type, nullptr, nullptr, 0); ret < 0)
+			{
+				cellVdec.notice("Hardware device '%s' is not available (type=0x%x): %s", av_hwdevice_get_type_name(config->device_type), type, utils::av_error_to_string(ret));
+				continue;
+			}
+
+			ctx->hw_device_ctx = av_buffer_ref(hw_device);
+			ctx->opaque = this;
+			ctx->get_format = [](AVCodecContext* ctx, const AVPixelFormat* formats) -> AVPixelFormat
+			{
+				const auto vdec = static_cast<vdec_context*>(ctx->opaque);
+
+				for (const AVPixelFormat* format = formats; *format != AV_PIX_FMT_NONE; format++)
+				{
+					if (*format == vdec->hw_pix_fmt)
+					{
+						return *format;
+					}
+				}
+
+				// The stream is not supported by the device (profile, size), decode it in software
+				cellVdec.warning("Hardware decoding not possible for this stream, falling back to software (handle=0x%x)", vdec->handle);
+				return avcodec_default_get_format(ctx, formats);
+			};
+
+			hw_pix_fmt = config->pix_fmt;
+			cellVdec.notice("Using hardware decoding with '%s' (type=0x%x)", av_hwdevice_get_type_name(config->device_type), type);
+			return;
+		}
+
+		cellVdec.warning("No hardware decoder available, using software decoding (type=0x%x)", type);
+	}
+
+	// Receives every picture the decoder has ready. Pictures are stamped with the AU that was current when they came out.
+	void receive_frames(const vdec_cmd& cmd, u64 au_usrd, CellVdecPicAttr attr, std::deque<vdec_frame>& decoded_frames)
+	{
+		while (!abort_decode && seq_id == cmd.seq_id)
+		{
+			// Keep receiving frames
+			vdec_frame frame;
+			frame.seq_id = cmd.seq_id;
+			frame.cmd_id = cmd.id;
+			frame.avf.reset(av_frame_alloc());
+
+			if (!frame.avf)
+			{
+				fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			}
+
+			if (int ret = avcodec_receive_frame(ctx, frame.avf.get()); ret < 0)
+			{
+				if (ret == AVERROR(EAGAIN) || ret == AVERROR(EOF))
+				{
+					break;
+				}
+
+				fmt::throw_exception("AU decoding error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd.seq_id, cmd.id, ret, utils::av_error_to_string(ret));
+			}
+
+			if (hw_pix_fmt != AV_PIX_FMT_NONE && frame->format == hw_pix_fmt)
+			{
+				download_hw_frame(cmd, frame);
+			}
+
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(60, 31, 102)
+			const int ticks_per_frame = ctx->ticks_per_frame;
+#else
+			const int ticks_per_frame = (codec_desc->props & AV_CODEC_PROP_FIELDS) ? 2 : 1;
+#endif
+
+#if LIBAVUTIL_VERSION_INT < AV_VERSION_INT(58, 29, 100)
+			const bool is_interlaced = frame->interlaced_frame != 0;
+#else
+			const bool is_interlaced = !!(frame->flags & AV_FRAME_FLAG_INTERLACED);
+#endif
+
+			if (is_interlaced)
+			{
+				// NPEB01838, NPUB31260
+				cellVdec.todo("Interlaced frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			}
+
+			if (frame->repeat_pict)
+			{
+				fmt::throw_exception("Repeated frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, repear_pict=0x%x)", handle, cmd.seq_id, cmd.id, frame->repeat_pict);
+			}
+
+			if (frame->pts != smin)
+			{
+				next_pts = frame->pts;
+			}
+
+			if (frame->pkt_dts != smin)
+			{
+				next_dts = frame->pkt_dts;
+			}
+
+			frame.pts = next_pts;
+			frame.dts = next_dts;
+			frame.userdata = au_usrd;
+			frame.attr = attr;
+
+			if (frc_set)
+			{
+				u64 amend = 0;
+
+				switch (frc_set)
+				{
+				case CELL_VDEC_FRC_24000DIV1001: amend = 1001 * 90000 / 24000; break;
+				case CELL_VDEC_FRC_24: amend = 90000 / 24; break;
+				case CELL_VDEC_FRC_25: amend = 90000 / 25; break;
+				case CELL_VDEC_FRC_30000DIV1001: amend = 1001 * 90000 / 30000; break;
+				case CELL_VDEC_FRC_30: amend = 90000 / 30; break;
+				case CELL_VDEC_FRC_50: amend = 90000 / 50; break;
+				case CELL_VDEC_FRC_60000DIV1001: amend = 1001 * 90000 / 60000; break;
+				case CELL_VDEC_FRC_60: amend = 90000 / 60; break;
+				default:
+				{
+					fmt::throw_exception("Invalid frame rate code set (handle=0x%x, seq_id=%d, cmd_id=%d, frc=0x%x)", handle, cmd.seq_id, cmd.id, frc_set);
+				}
+				}
+
+				next_pts += amend;
+				next_dts += amend;
+				frame.frc = frc_set;
+			}
+			else if (ctx->time_base.num == 0)
+			{
+				if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
+				{
+					cellVdec.error("time_base.num is 0 (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd.seq_id, cmd.id, ctx->time_base.num, ctx->time_base.den, ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
+					log_time_base = ctx->time_base;
+				}
+
+				// Hack
+				const u64 amend = u64{90000} / 30;
+				frame.frc = CELL_VDEC_FRC_30;
+				next_pts += amend;
+				next_dts += amend;
+			}
+			else
+			{
+				u64 amend = u64{90000} * ctx->time_base.num * ticks_per_frame / ctx->time_base.den;
+				const auto freq = 1. * ctx->time_base.den / ctx->time_base.num / ticks_per_frame;
+
+				if (std::abs(freq - 23.976) < 0.002)
+					frame.frc = CELL_VDEC_FRC_24000DIV1001;
+				else if (std::abs(freq - 24.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_24;
+				else if (std::abs(freq - 25.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_25;
+				else if (std::abs(freq - 29.970) < 0.002)
+					frame.frc = CELL_VDEC_FRC_30000DIV1001;
+				else if (std::abs(freq - 30.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_30;
+				else if (std::abs(freq - 50.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_50;
+				else if (std::abs(freq - 59.940) < 0.002)
+					frame.frc = CELL_VDEC_FRC_60000DIV1001;
+				else if (std::abs(freq - 60.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_60;
+				else
+				{
+					if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
+					{
+						// 1/1000 usually means that the time stamps are written in 1ms units and that the frame rate may vary.
+						cellVdec.error("Unsupported time_base (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd.seq_id, cmd.id, ctx->time_base.num, ctx->time_base.den, ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
+						log_time_base = ctx->time_base;
+					}
+
+					// Hack
+					amend = u64{90000} / 30;
+					frame.frc = CELL_VDEC_FRC_30;
+				}
+
+				next_pts += amend;
+				next_dts += amend;
+			}
+
+			cellVdec.trace("Got picture (handle=0x%x, seq_id=%d, cmd_id=%d, pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", handle, cmd.seq_id, cmd.id, frame.pts, frame->pts, frame.dts, frame->pkt_dts);
+
+			decoded_frames.push_back(std::move(frame));
+		}
+	}
+
+	void download_hw_frame(const vdec_cmd& cmd, vdec_frame& frame)
+	{
+		std::unique_ptr<AVFrame, vdec_frame::frame_dtor> sw_frame(av_frame_alloc());
+
+		if (!sw_frame)
+		{
+			fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+		}
+
+		if (int ret = av_hwframe_transfer_data(sw_frame.get(), frame.avf.get(), 0); ret < 0)
+		{
+			fmt::throw_exception("av_hwframe_transfer_data() failed (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd.seq_id, cmd.id, ret, utils::av_error_to_string(ret));
+		}
+
+		av_frame_copy_props(sw_frame.get(), frame.avf.get());
+		frame.avf = std::move(sw_frame);
+	}
+
+	// Hands the pictures to the game one by one, waiting for space in the image queue
+	void output_frames(ppu_thread& ppu, u32 vid, const vdec_cmd& cmd, std::deque<vdec_frame>& decoded_frames)
+	{
+		while (!decoded_frames.empty() && seq_id == cmd.seq_id)
+		{
+			// Wait until there is free space in the image queue.
+			// Do this after pushing the frame to the queue. That way the game can consume the frame and we can move on.
+			u32 elapsed = 0;
+			while (thread_ctrl::state() != thread_state::aborting && !abort_decode && seq_id == cmd.seq_id)
+			{
+				{
+					std::lock_guard lock{mutex};
+
+					if (out_queue.size() <= out_max)
+					{
+						break;
+					}
+				}
+
+				thread_ctrl::wait_for(10000);
+
+				if (elapsed++ >= 500) // 5 seconds
+				{
+					cellVdec.error("Video au decode has been waiting for a consumer for 5 seconds. (handle=0x%x, seq_id=%d, cmd_id=%d, queue_size=%d)", handle, cmd.seq_id, cmd.id, out_queue.size());
+					elapsed = 0;
+				}
+			}
+
+			if (thread_ctrl::state() == thread_state::aborting || abort_decode || seq_id != cmd.seq_id)
+			{
+				break;
+			}
+
+			{
+				std::lock_guard lock{mutex};
+				out_queue.push_back(std::move(decoded_frames.front()));
+				decoded_frames.pop_front();
+			}
+
+			cellVdec.trace("Sending CELL_VDEC_MSG_TYPE_PICOUT (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
+			lv2_obj::sleep(ppu);
+		}
 	}
 
 	void exec(ppu_thread& ppu, u32 vid)
@@ -354,6 +646,22 @@ struct vdec_context final
 			{
 				cellVdec.trace("End sequence... (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
 
+				if ((ctx->active_thread_type & FF_THREAD_FRAME) && !abort_decode && seq_id == cmd->seq_id)
+				{
+					// Frame threading holds pictures back, they have to be flushed out before SEQDONE
+					if (int ret = avcodec_send_packet(ctx, nullptr); ret < 0 && ret != AVERROR_EOF)
+					{
+						fmt::throw_exception("Decoder drain error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
+					}
+
+					std::deque<vdec_frame> decoded_frames;
+					receive_frames(*cmd, last_au_usrd, CELL_VDEC_PICITEM_ATTR_NORMAL, decoded_frames);
+					output_frames(ppu, vid, *cmd, decoded_frames);
+
+					// Leave draining mode
+					avcodec_flush_buffers(ctx);
+				}
+
 				{
 					std::lock_guard lock{mutex};
 					seq_state = sequence_state::dormant;
@@ -377,6 +685,7 @@ struct vdec_context final
 				const u64 au_pts = u64{cmd->au.pts.upper} << 32 | cmd->au.pts.lower;
 				const u64 au_dts = u64{cmd->au.dts.upper} << 32 | cmd->au.dts.lower;
 				au_usrd = cmd->au.userData;
+				last_au_usrd = au_usrd;
 
 				packet.data = vm::_ptr<u8>(au_addr);
 				packet.size = au_size;
@@ -410,148 +719,7 @@ struct vdec_context final
 						fmt::throw_exception("AU queuing error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
 					}
 
-					while (!abort_decode && seq_id == cmd->seq_id)
-					{
-						// Keep receiving frames
-						vdec_frame frame;
-						frame.seq_id = cmd->seq_id;
-						frame.cmd_id = cmd->id;
-						frame.avf.reset(av_frame_alloc());
-
-						if (!frame.avf)
-						{
-							fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						}
-
-						if (int ret = avcodec_receive_frame(ctx, frame.avf.get()); ret < 0)
-						{
-							if (ret == AVERROR(EAGAIN) || ret == AVERROR(EOF))
-							{
-								break;
-							}
-
-							fmt::throw_exception("AU decoding error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
-						}
-
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(60, 31, 102)
-						const int ticks_per_frame = ctx->ticks_per_frame;
-#else
-						const int ticks_per_frame = (codec_desc->props & AV_CODEC_PROP_FIELDS) ? 2 : 1;
-#endif
-
-#if LIBAVUTIL_VERSION_INT < AV_VERSION_INT(58, 29, 100)
-						const bool is_interlaced = frame->interlaced_frame != 0;
-#else
-						const bool is_interlaced = !!(frame->flags & AV_FRAME_FLAG_INTERLACED);
-#endif
-
-						if (is_interlaced)
-						{
-							// NPEB01838, NPUB31260
-							cellVdec.todo("Interlaced frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						}
-
-						if (frame->repeat_pict)
-						{
-							fmt::throw_exception("Repeated frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, repear_pict=0x%x)", handle, cmd->seq_id, cmd->id, frame->repeat_pict);
-						}
-
-						if (frame->pts != smin)
-						{
-							next_pts = frame->pts;
-						}
-
-						if (frame->pkt_dts != smin)
-						{
-							next_dts = frame->pkt_dts;
-						}
-
-						frame.pts = next_pts;
-						frame.dts = next_dts;
-						frame.userdata = au_usrd;
-						frame.attr = attr;
-
-						if (frc_set)
-						{
-							u64 amend = 0;
-
-							switch (frc_set)
-							{
-							case CELL_VDEC_FRC_24000DIV1001: amend = 1001 * 90000 / 24000; break;
-							case CELL_VDEC_FRC_24: amend = 90000 / 24; break;
-							case CELL_VDEC_FRC_25: amend = 90000 / 25; break;
-							case CELL_VDEC_FRC_30000DIV1001: amend = 1001 * 90000 / 30000; break;
-							case CELL_VDEC_FRC_30: amend = 90000 / 30; break;
-							case CELL_VDEC_FRC_50: amend = 90000 / 50; break;
-							case CELL_VDEC_FRC_60000DIV1001: amend = 1001 * 90000 / 60000; break;
-							case CELL_VDEC_FRC_60: amend = 90000 / 60; break;
-							default:
-							{
-								fmt::throw_exception("Invalid frame rate code set (handle=0x%x, seq_id=%d, cmd_id=%d, frc=0x%x)", handle, cmd->seq_id, cmd->id, frc_set);
-							}
-							}
-
-							next_pts += amend;
-							next_dts += amend;
-							frame.frc = frc_set;
-						}
-						else if (ctx->time_base.num == 0)
-						{
-							if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
-							{
-								cellVdec.error("time_base.num is 0 (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd->seq_id, cmd->id, ctx->time_base.num, ctx->time_base.den, ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
-								log_time_base = ctx->time_base;
-							}
-
-							// Hack
-							const u64 amend = u64{90000} / 30;
-							frame.frc = CELL_VDEC_FRC_30;
-							next_pts += amend;
-							next_dts += amend;
-						}
-						else
-						{
-							u64 amend = u64{90000} * ctx->time_base.num * ticks_per_frame / ctx->time_base.den;
-							const auto freq = 1. * ctx->time_base.den / ctx->time_base.num / ticks_per_frame;
-
-							if (std::abs(freq - 23.976) < 0.002)
-								frame.frc = CELL_VDEC_FRC_24000DIV1001;
-							else if (std::abs(freq - 24.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_24;
-							else if (std::abs(freq - 25.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_25;
-							else if (std::abs(freq - 29.970) < 0.002)
-								frame.frc = CELL_VDEC_FRC_30000DIV1001;
-							else if (std::abs(freq - 30.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_30;
-							else if (std::abs(freq - 50.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_50;
-							else if (std::abs(freq - 59.940) < 0.002)
-								frame.frc = CELL_VDEC_FRC_60000DIV1001;
-							else if (std::abs(freq - 60.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_60;
-							else
-							{
-								if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
-								{
-									// 1/1000 usually means that the time stamps are written in 1ms units and that the frame rate may vary.
-									cellVdec.error("Unsupported time_base (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd->seq_id, cmd->id, ctx->time_base.num, ctx->time_base.den, ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
-									log_time_base = ctx->time_base;
-								}
-
-								// Hack
-								amend = u64{90000} / 30;
-								frame.frc = CELL_VDEC_FRC_30;
-							}
-
-							next_pts += amend;
-							next_dts += amend;
-						}
-
-						cellVdec.trace("Got picture (handle=0x%x, seq_id=%d, cmd_id=%d, pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", handle, cmd->seq_id, cmd->id, frame.pts, frame->pts, frame.dts, frame->pkt_dts);
-
-						decoded_frames.push_back(std::move(frame));
-					}
+					receive_frames(*cmd, au_usrd, attr, decoded_frames);
 				}
 
 				if (thread_ctrl::state() != thread_state::aborting)
@@ -563,46 +731,7 @@ struct vdec_context final
 					cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_AUDONE, CELL_OK, cb_arg);
 					lv2_obj::sleep(ppu);
 
-					while (!decoded_frames.empty() && seq_id == cmd->seq_id)
-					{
-						// Wait until there is free space in the image queue.
-						// Do this after pushing the frame to the queue. That way the game can consume the frame and we can move on.
-						u32 elapsed = 0;
-						while (thread_ctrl::state() != thread_state::aborting && !abort_decode && seq_id == cmd->seq_id)
-						{
-							{
-								std::lock_guard lock{mutex};
-
-								if (out_queue.size() <= out_max)
-								{
-									break;
-								}
-							}
-
-							thread_ctrl::wait_for(10000);
-
-							if (elapsed++ >= 500) // 5 seconds
-							{
-								cellVdec.error("Video au decode has been waiting for a consumer for 5 seconds. (handle=0x%x, seq_id=%d, cmd_id=%d, queue_size=%d)", handle, cmd->seq_id, cmd->id, out_queue.size());
-								elapsed = 0;
-							}
-						}
-
-						if (thread_ctrl::state() == thread_state::aborting || abort_decode || seq_id != cmd->seq_id)
-						{
-							break;
-						}
-
-						{
-							std::lock_guard lock{mutex};
-							out_queue.push_back(std::move(decoded_frames.front()));
-							decoded_frames.pop_front();
-						}
-
-						cellVdec.trace("Sending CELL_VDEC_MSG_TYPE_PICOUT (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
-						lv2_obj::sleep(ppu);
-					}
+					output_frames(ppu, vid, *cmd, decoded_frames);
 				}
 
 				if (abort_decode || seq_id != cmd->seq_id)
@@ -1256,72 +1385,54 @@ error_code cellVdecGetPictureExt(ppu_thread& ppu, u32 handle, vm::cptr<CellVdecP
 
 	if (outBuff)
 	{
-		const int w = frame->width;
-		const int h = frame->height;
-
-		AVPixelFormat out_f = AV_PIX_FMT_YUV420P;
-
-		std::unique_ptr<u8[]> alpha_plane;
-
-		switch (const u32 type = format->formatType)
-		{
-		case CELL_VDEC_PICFMT_ARGB32_ILV: out_f = AV_PIX_FMT_ARGB; alpha_plane.reset(new u8[w * h]); break;
-		case CELL_VDEC_PICFMT_RGBA32_ILV: out_f = AV_PIX_FMT_RGBA; alpha_plane.reset(new u8[w * h]); break;
-		case CELL_VDEC_PICFMT_UYVY422_ILV: out_f = AV_PIX_FMT_UYVY422; break;
-		case CELL_VDEC_PICFMT_YUV420_PLANAR: out_f = AV_PIX_FMT_YUV420P; break;
-		default:
-		{
-			fmt::throw_exception("cellVdecGetPictureExt: Unknown formatType (handle=0x%x, seq_id=%d, cmd_id=%d, type=%d)", handle, frame.seq_id, frame.cmd_id, type);
-		}
-		}
-
-		// TODO: color matrix
+		const u32 w = frame->width;
+		const u32 h = frame->height;
 
-		if (alpha_plane)
-		{
-			std::memset(alpha_plane.get(), format->alpha, w * h);
-		}
-
-		AVPixelFormat in_f = AV_PIX_FMT_YUV420P;
+		utils::yuv420_image image{};
+		image.y = frame->data[0];
+		image.u = frame->data[1];
+		image.v = frame->data[2];
+		image.y_pitch = frame->linesize[0];
+		image.uv_pitch = frame->linesize[1];
+		image.width = w;
+		image.height = h;
 
 		switch (frame->format)
 		{
 		case AV_PIX_FMT_YUVJ420P:
-			cellVdec.error("cellVdecGetPictureExt: experimental AVPixelFormat (handle=0x%x, seq_id=%d, cmd_id=%d, format=%d). This may cause suboptimal video quality.", handle, frame.seq_id, frame.cmd_id, frame->format);
-			[[fallthrough]];
+			image.full_range = true;
+			break;
 		case AV_PIX_FMT_YUV420P:
-			in_f = alpha_plane ? AV_PIX_FMT_YUVA420P : static_cast<AVPixelFormat>(frame->format);
+			image.full_range = frame->color_range == AVCOL_RANGE_JPEG;
+			break;
+		case AV_PIX_FMT_NV12:
+			// Hardware decoders
+			image.semi_planar = true;
+			image.full_range = frame->color_range == AVCOL_RANGE_JPEG;
 			break;
 		default:
 			fmt::throw_exception("cellVdecGetPictureExt: Unknown frame format (%d)", frame->format);
 		}
 
-		cellVdec.trace("cellVdecGetPictureExt: handle=0x%x, seq_id=%d, cmd_id=%d, w=%d, h=%d, frameFormat=%d, formatType=%d, in_f=%d, out_f=%d, alpha_plane=%d, alpha=%d, colorMatrixType=%d", handle, frame.seq_id, frame.cmd_id, w, h, frame->format, format->formatType, +in_f, +out_f, !!alpha_plane, format->alpha, format->colorMatrixType);
-
-		vdec->sws = sws_getCachedContext(vdec->sws, w, h, in_f, w, h, out_f, SWS_POINT, nullptr, nullptr, nullptr);
-
-		u8* in_data[4] = { frame->data[0], frame->data[1], frame->data[2], alpha_plane.get() };
-		int in_line[4] = { frame->linesize[0], frame->linesize[1], frame->linesize[2], w * 1 };
-		u8* out_data[4] = { outBuff.get_ptr() };
-		int out_line[4] = { w * 4 }; // RGBA32 or ARGB32
+		cellVdec.trace("cellVdecGetPictureExt: handle=0x%x, seq_id=%d, cmd_id=%d, w=%d, h=%d, frameFormat=%d, formatType=%d, alpha=%d, colorMatrixType=%d", handle, frame.seq_id, frame.cmd_id, w, h, frame->format, format->formatType, format->alpha, format->colorMatrixType);
 
 		// TODO:
 		// It's possible that we need to align the pitch to 128 here.
 		// PS HOME seems to rely on this somehow in certain cases.
 
-		if (!alpha_plane)
-		{
-			// YUV420P or UYVY422
-			out_data[1] = out_data[0] + w * h;
-			out_data[2] = out_data[0] + w * h * 5 / 4;
+		const auto matrix = format->colorMatrixType == CELL_VDEC_COLOR_MATRIX_TYPE_BT709 ? utils::color_matrix::bt709 : utils::color_matrix::bt601;
 
-			if (const int ret = av_image_fill_linesizes(out_line, out_f, w); ret < 0)
-			{
-				fmt::throw_exception("cellVdecGetPictureExt: av_image_fill_linesizes failed (handle=0x%x, seq_id=%d, cmd_id=%d, ret=0x%x): %s", handle, frame.seq_id, frame.cmd_id, ret, utils::av_error_to_string(ret));
-			}
+		switch (const u32 type = format->formatType)
+		{
+		case CELL_VDEC_PICFMT_ARGB32_ILV: utils::yuv420_to_rgb32(image, outBuff.get_ptr(), w * 4, utils::rgb32_layout::argb, matrix, format->alpha); break;
+		case CELL_VDEC_PICFMT_RGBA32_ILV: utils::yuv420_to_rgb32(image, outBuff.get_ptr(), w * 4, utils::rgb32_layout::rgba, matrix, format->alpha); break;
+		case CELL_VDEC_PICFMT_UYVY422_ILV: utils::yuv420_to_uyvy422(image, outBuff.get_ptr(), utils::align(w, 2) * 2); break;
+		case CELL_VDEC_PICFMT_YUV420_PLANAR: utils::yuv420_to_yuv420p(image, outBuff.get_ptr()); break;
+		default:
+		{
+			fmt::throw_exception("cellVdecGetPictureExt: Unknown formatType (handle=0x%x, seq_id=%d, cmd_id=%d, type=%d)", handle, frame.seq_id, frame.cmd_id, type);
+		}
 		}
-
-		sws_scale(vdec->sws, in_data, in_line, 0, h, out_data, out_line);
 	}
 
 	return CELL_OK;
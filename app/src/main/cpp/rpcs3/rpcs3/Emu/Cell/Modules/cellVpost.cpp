@@ -1,24 +1,7 @@
 #include "stdafx.h"
 #include "Emu/IdManager.h"
 #include "Emu/Cell/PPUModule.h"
-
-#ifdef _MSC_VER
-#pragma warning(push, 0)
-#else
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wall"
-#pragma GCC diagnostic ignored "-Wextra"
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-#endif
-extern "C"
-{
-#include "libswscale/swscale.h"
-}
-#ifdef _MSC_VER
-#pragma warning(pop)
-#else
-#pragma GCC diagnostic pop
-#endif
+#include "util/yuv_convert.hpp"
 
 #include "cellVpost.h"
 
@@ -270,27 +253,20 @@ error_code cellVpostExec(u32 handle, vm::cptr<u8> inPicBuff, vm::cptr<CellVpostC
 	picInfo->reserved1 = 0;
 	picInfo->reserved2 = 0;
 
-	//u64 stamp0 = get_guest_system_time();
-	std::unique_ptr<u8[]> pA(new u8[w*h]);
-
-	memset(pA.get(), ctrlParam->outAlpha, w*h);
-
-	//u64 stamp1 = get_guest_system_time();
-
-	vpost->sws = sws_getCachedContext(vpost->sws, w, h, AV_PIX_FMT_YUVA420P, ow, oh, AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr);
-
-	//u64 stamp2 = get_guest_system_time();
+	utils::yuv420_image image{};
+	image.y = inPicBuff.get_ptr();
+	image.u = image.y + w * h;
+	image.v = image.y + w * h * 5 / 4;
+	image.y_pitch = w;
+	image.uv_pitch = w / 2;
+	image.width = w;
+	image.height = h;
+	image.full_range = ctrlParam->inQuantRange == CELL_VPOST_QUANT_RANGE_FULL;
 
-	const u8* in_data[4] = { &inPicBuff[0], &inPicBuff[w * h], &inPicBuff[w * h * 5 / 4], pA.get() };
-	int ws = w;
-	int in_line[4] = { ws, ws/2, ws/2, ws };
-	u8* out_data[4] = { outPicBuff.get_ptr(), nullptr, nullptr, nullptr };
-	int out_line[4] = { static_cast<int>(ow * 4), 0, 0, 0 };
+	const auto matrix = ctrlParam->inColorMatrix == CELL_VPOST_COLOR_MATRIX_BT709 ? utils::color_matrix::bt709 : utils::color_matrix::bt601;
 
-	sws_scale(vpost->sws, in_data, in_line, 0, h, out_data, out_line);
+	utils::yuv420_to_rgb32(image, outPicBuff.get_ptr(), ow * 4, ow, oh, utils::rgb32_layout::rgba, matrix, ctrlParam->outAlpha);
 
-	//ConLog.Write("cellVpostExec() perf (access=%d, getContext=%d, scale=%d, finalize=%d)",
-		//stamp1 - stamp0, stamp2 - stamp1, stamp3 - stamp2, get_guest_system_time() - stamp3);
 	return CELL_OK;
 }
 
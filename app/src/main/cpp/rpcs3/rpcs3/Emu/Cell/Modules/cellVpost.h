@@ -1,23 +1,5 @@
 #pragma once
 
-#ifdef _MSC_VER
-#pragma warning(push, 0)
-#else
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wall"
-#pragma GCC diagnostic ignored "-Wextra"
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-#endif
-extern "C"
-{
-#include "libswscale/swscale.h"
-}
-#ifdef _MSC_VER
-#pragma warning(pop)
-#else
-#pragma GCC diagnostic pop
-#endif
-
 // Error Codes
 enum CellVpostError : u32
 {
@@ -344,15 +326,8 @@ public:
 
 	const bool to_rgba;
 
-	SwsContext* sws{};
-
 	VpostInstance(bool rgba)
 		: to_rgba(rgba)
 	{
 	}
-
-	~VpostInstance()
-	{
-		sws_freeContext(sws);
-	}
 };
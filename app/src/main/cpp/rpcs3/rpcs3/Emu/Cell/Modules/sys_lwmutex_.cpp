@@ -7,10 +7,97 @@
 #include "Emu/Cell/lv2/sys_mutex.h"
 #include "sysPrxForUser.h"
 
+#include "Emu/IdManager.h"
+#include "Emu/Cell/PPUThread.h"
+
 #include "util/asm.hpp"
+#include "util/sysinfo.hpp"
+
+#include <thread>
 
 LOG_CHANNEL(sysPrxForUser);
 
+// Upper bound of spinning on a contended lightweight mutex before sleeping in lv2 (microseconds)
+constexpr u64 lwmutex_spin_max_us = 20;
+
+// Learned spin durations (TSC ticks) for lightweight mutexes hashed by address
+static atomic_t<u32> s_lwmutex_spin[256]{};
+
+// Try to take a contended lightweight mutex without entering lv2.
+// The time limit adapts to how long recent acquisitions of the mutex took, and spinning stops early if the owner sleeps in lv2.
+// It is measured in time rather than TSC ticks since the ARM counter runs at a few tens of MHz only.
+// Late in the spin the host thread yields instead of pausing, so an owner preempted on the same (possibly little) core can run.
+static bool lwmutex_spin_lock(ppu_thread& ppu, vm::ptr<sys_lwmutex_t> lwmutex, be_t<u32> tid)
+{
+	auto& learned = s_lwmutex_spin[(lwmutex.addr() / 8) % std::size(s_lwmutex_spin)];
+
+	const u64 ticks_per_us = std::max<u64>(utils::get_tsc_freq() / 1'000'000, 1);
+	const u64 limit = std::min<u64>(lwmutex_spin_max_us * ticks_per_us, u64{learned} * 2 + ticks_per_us);
+	const u64 start = utils::get_tsc();
+
+	u32 checked_owner = lwmutex_free;
+	u64 elapsed = 0;
+
+	for (u32 i = 0; elapsed < limit; i++, elapsed = utils::get_tsc() - start)
+	{
+		const u32 owner = lwmutex->vars.owner.load();
+
+		if (owner == lwmutex_free)
+		{
+			if (lwmutex->vars.owner.compare_and_swap_test(lwmutex_free, tid))
+			{
+				// Spinning paid off, follow the time it took
+				learned.release(static_cast<u32>(learned + (static_cast<s64>(elapsed) - learned) / 8));
+				return true;
+			}
+
+			continue;
+		}
+
+		if (owner == lwmutex_dead || owner == lwmutex_reserved)
+		{
+			// Deleted, or being handed over to a thread sleeping in lv2
+			break;
+		}
+
+		if (owner != checked_owner || i % 32 == 0)
+		{
+			checked_owner = owner;
+
+			bool sleeping = false;
+
+			idm::check<named_thread<ppu_thread>>(owner, [&](ppu_thread& cpu)
+			{
+				sleeping = !!(cpu.state & cpu_flag::suspend);
+			});
+
+			if (sleeping)
+			{
+				// The owner will not release it soon
+				break;
+			}
+		}
+
+		if (ppu.test_stopped())
+		{
+			break;
+		}
+
+		if (elapsed < limit / 2)
+		{
+			utils::pause();
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// Spinning did not pay off, spin less next time
+	learned.release(learned - learned / 8);
+	return false;
+}
+
 error_code sys_lwmutex_create(ppu_thread& ppu, vm::ptr<sys_lwmutex_t> lwmutex, vm::ptr<sys_lwmutex_attribute_t> attr)
 {
 	sysPrxForUser.trace("sys_lwmutex_create(lwmutex=*0x%x, attr=*0x%x)", lwmutex, attr);
@@ -149,18 +236,10 @@ error_code sys_lwmutex_lock(ppu_thread& ppu, vm::ptr<sys_lwmutex_t> lwmutex, u64
 		return CELL_EINVAL;
 	}
 
-	for (u32 i = 0; i < 10; i++)
+	if (lwmutex_spin_lock(ppu, lwmutex, tid))
 	{
-		busy_wait();
-
-		if (lwmutex->vars.owner.load() == lwmutex_free)
-		{
-			if (lwmutex->vars.owner.compare_and_swap_test(lwmutex_free, tid))
-			{
-				// locking succeeded
-				return CELL_OK;
-			}
-		}
+		// locking succeeded
+		return CELL_OK;
 	}
 
 	// atomically increment waiter value using 64 bit op
@@ -208,17 +287,9 @@ error_code sys_lwmutex_lock(ppu_thread& ppu, vm::ptr<sys_lwmutex_t> lwmutex, u64
 	{
 		while (true)
 		{
-			for (u32 i = 0; i < 10; i++)
+			if (lwmutex_spin_lock(ppu, lwmutex, tid))
 			{
-				busy_wait();
-
-				if (lwmutex->vars.owner.load() == lwmutex_free)
-				{
-					if (lwmutex->vars.owner.compare_and_swap_test(lwmutex_free, tid))
-					{
-						return CELL_OK;
-					}
-				}
+				return CELL_OK;
 			}
 
 			lwmutex->all_info++;
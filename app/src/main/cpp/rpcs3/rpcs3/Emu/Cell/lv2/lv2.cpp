@@ -59,6 +59,7 @@
 #include "util/tsc.hpp"
 #include "util/sysinfo.hpp"
 #include "util/init_mutex.hpp"
+#include "util/timer_wheel.hpp"
 
 #if defined(ARCH_X64)
 #ifdef _MSC_VER
@@ -1299,7 +1300,7 @@ thread_local DECLARE(lv2_obj::g_postpone_notify_barrier){};
 thread_local DECLARE(lv2_obj::g_to_awake);
 
 // Scheduler queue for timeouts (wait until -> thread)
-static std::deque<std::pair<u64, class cpu_thread*>> g_waiting;
+static utils::timer_wheel<class cpu_thread*> g_waiting;
 
 // Threads which must call lv2_obj::sleep before the scheduler starts
 static std::deque<class cpu_thread*> g_to_sleep;
@@ -1568,14 +1569,7 @@ bool lv2_obj::sleep_unlocked(cpu_thread& thread, u64 timeout, u64 current_time)
 		const u64 wait_until = start_time + std::min<u64>(timeout, ~start_time);
 
 		// Register timeout if necessary
-		for (auto it = g_waiting.cbegin(), end = g_waiting.cend();; it++)
-		{
-			if (it == end || it->first > wait_until)
-			{
-				g_waiting.emplace(it, wait_until, &thread);
-				break;
-			}
-		}
+		g_waiting.insert(wait_until, &thread);
 	}
 
 	return return_val;
@@ -1726,14 +1720,10 @@ bool lv2_obj::awake_unlocked(cpu_thread* cpu, s32 prio)
 			it = &next->next_ppu;
 		}
 
-		// Unregister timeout if necessary
-		for (auto it = g_waiting.cbegin(), end = g_waiting.cend(); it != end; it++)
+		// Unregister timeout if necessary, only PPU threads which slept with a timeout can be registered and their key is end_time
+		if (const u64 end_time = static_cast<ppu_thread*>(cpu)->end_time; end_time != umax)
 		{
-			if (it->second == cpu)
-			{
-				g_waiting.erase(it);
-				break;
-			}
+			g_waiting.erase(end_time, cpu);
 		}
 
 		ppu_log.trace("awake(): %s", cpu->id);
@@ -1744,7 +1734,28 @@ bool lv2_obj::awake_unlocked(cpu_thread* cpu, s32 prio)
 	bool changed_queue = prio == yield_cmd;
 
 	s32 lowest_new_priority = smax;
-	const bool has_free_hw_thread_space = count_non_sleeping_threads().onproc_count < g_cfg.core.ppu_threads + 0u;
+
+	const auto current_ppu = cpu_thread::get_current<ppu_thread>();
+
+	// Counting running threads walks the run queue, only do it if a signaled thread may preempt the caller (see below)
+	bool has_free_hw_thread_space = false;
+
+	if (current_ppu && prio != yield_cmd)
+	{
+		const s32 current_prio = current_ppu->prio.load().prio;
+		bool may_preempt = false;
+
+		if (cpu)
+		{
+			may_preempt = static_cast<ppu_thread*>(cpu)->prio.load().prio < current_prio;
+		}
+		else
+		{
+			may_preempt = std::any_of(g_to_awake.begin(), g_to_awake.end(), [&](cpu_thread* _cpu) { return static_cast<ppu_thread*>(_cpu)->prio.load().prio < current_prio; });
+		}
+
+		has_free_hw_thread_space = may_preempt && count_non_sleeping_threads().onproc_count < g_cfg.core.ppu_threads + 0u;
+	}
 
 	if (cpu && prio != yield_cmd)
 	{
@@ -1785,8 +1796,6 @@ bool lv2_obj::awake_unlocked(cpu_thread* cpu, s32 prio)
 		}
 	}
 
-	const auto current_ppu = cpu_thread::get_current<ppu_thread>();
-
 	// Remove pending if necessary
 	if (current_ppu)
 	{
@@ -1875,20 +1884,15 @@ void lv2_obj::schedule_all(u64 current_time)
 	}
 
 	// Check registered timeouts
-	while (!g_waiting.empty())
+	if (!g_waiting.empty())
 	{
-		const auto pair = &g_waiting.front();
-
 		if (!current_time)
 		{
 			current_time = get_guest_system_time();
 		}
 
-		if (pair->first <= current_time)
+		g_waiting.advance(current_time, [&](u64, cpu_thread* target)
 		{
-			const auto target = pair->second;
-			g_waiting.pop_front();
-
 			if (target != cpu_thread::get_current())
 			{
 				// Change cpu_thread::state for the lightweight notification to work
@@ -1905,12 +1909,7 @@ void lv2_obj::schedule_all(u64 current_time)
 					*it++ = &target->state;
 				}
 			}
-		}
-		else
-		{
-			// The list is sorted so assume no more timeouts
-			break;
-		}
+		});
 	}
 
 	if (it < std::end(g_to_notify))
@@ -1130,7 +1130,7 @@ error_code sys_fs_read(ppu_thread& ppu, u32 fd, vm::ptr<void> buf, u64 nbytes, v
 		return CELL_OK;
 	}
 
-	std::unique_lock lock(file->mp->mutex);
+	std::unique_lock lock(file->mutex);
 
 	if (!file->file)
 	{
@@ -1210,7 +1210,7 @@ error_code sys_fs_write(ppu_thread& ppu, u32 fd, vm::cptr<void> buf, u64 nbytes,
 		return CELL_EROFS;
 	}
 
-	std::unique_lock lock(file->mp->mutex);
+	std::unique_lock lock(file->mutex);
 
 	if (!file->file)
 	{
@@ -1263,6 +1263,7 @@ error_code sys_fs_close(ppu_thread& ppu, u32 fd)
 
 	{
 		std::lock_guard lock(file->mp->mutex);
+		std::lock_guard file_lock(file->mutex);
 
 		if (!file->file)
 		{
@@ -1630,7 +1631,7 @@ error_code sys_fs_fstat(ppu_thread& ppu, u32 fd, vm::ptr<CellFsStat> sb)
 		return CELL_EBADF;
 	}
 
-	std::unique_lock lock(file->mp->mutex);
+	std::shared_lock lock(file->mutex);
 
 	if (!file->file)
 	{
@@ -2001,8 +2002,8 @@ error_code sys_fs_fcntl(ppu_thread& ppu, u32 fd, u32 op, vm::ptr<void> _arg, u32
 			sys_fs.error("%s type: Writing %u bytes to FD=%d (path=%s)", file->type, arg->size, file->name.data());
 		}
 
-		std::unique_lock wlock(file->mp->mutex, std::defer_lock);
-		std::shared_lock rlock(file->mp->mutex, std::defer_lock);
+		std::unique_lock wlock(file->mutex, std::defer_lock);
+		std::shared_lock rlock(file->mutex, std::defer_lock);
 
 		if (op == 0x8000000b)
 		{
@@ -2074,7 +2075,7 @@ error_code sys_fs_fcntl(ppu_thread& ppu, u32 fd, u32 op, vm::ptr<void> _arg, u32
 
 		sys_fs.warning("sys_fs_fcntl(0x80000009): fd=%d, arg->offset=0x%x, size=0x%x (file: %s)", fd, arg->offset, _size, *file);
 
-		std::lock_guard lock(file->mp->mutex);
+		reader_lock lock(file->mutex);
 
 		if (!file->file)
 		{
@@ -2613,7 +2614,7 @@ error_code sys_fs_lseek(ppu_thread& ppu, u32 fd, s64 offset, s32 whence, vm::ptr
 		return CELL_EBADF;
 	}
 
-	std::unique_lock lock(file->mp->mutex);
+	std::unique_lock lock(file->mutex);
 
 	if (!file->file)
 	{
@@ -2659,7 +2660,7 @@ error_code sys_fs_fdatasync(ppu_thread& ppu, u32 fd)
 		return CELL_EBADF;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	reader_lock lock(file->mutex);
 
 	if (!file->file)
 	{
@@ -2684,7 +2685,7 @@ error_code sys_fs_fsync(ppu_thread& ppu, u32 fd)
 		return CELL_EBADF;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	reader_lock lock(file->mutex);
 
 	if (!file->file)
 	{
@@ -2840,7 +2841,7 @@ error_code sys_fs_ftruncate(ppu_thread& ppu, u32 fd, u64 size)
 		return CELL_EROFS;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard lock(file->mutex);
 
 	if (!file->file)
 	{
@@ -3134,7 +3135,7 @@ error_code sys_fs_lsn_lock(ppu_thread&, u32 fd)
 		return CELL_OK;
 	}
 
-	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard lock(file->mutex);
 	file->lock.compare_and_swap(0, 1);
 	return CELL_OK;
 }
@@ -3157,7 +3158,7 @@ error_code sys_fs_lsn_unlock(ppu_thread&, u32 fd)
 	}
 
 	// Unlock unconditionally
-	std::lock_guard lock(file->mp->mutex);
+	std::lock_guard lock(file->mutex);
 	file->lock.compare_and_swap(1, 0);
 	return CELL_OK;
 }
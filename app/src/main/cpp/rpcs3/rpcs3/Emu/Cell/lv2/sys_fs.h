@@ -229,6 +229,7 @@ struct lv2_fs_object
 	static constexpr u32 id_step = 1;
 	static constexpr u32 id_count = 255 - id_base;
 	static constexpr bool id_lowest = true;
+	static constexpr bool id_own_lock = true; // Hot in every file syscall, must not depend on id_manager::g_mutex
 	SAVESTATE_INIT_POS(49);
 
 	// File Name (max 1055)
@@ -290,6 +291,10 @@ struct lv2_file final : lv2_fs_object
 	// Stream lock
 	atomic_t<u32> lock{0};
 
+	// Guards the host handle and its position for I/O on this descriptor, so that different files do not contend.
+	// Replacing or closing the handle also requires the mount point mutex (locked first).
+	mutable shared_mutex mutex;
+
 	// Some variables for convenience of data restoration
 	struct save_restore_t
 	{
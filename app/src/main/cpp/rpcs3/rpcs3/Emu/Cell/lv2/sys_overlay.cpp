@@ -167,6 +167,7 @@ error_code sys_overlay_load_module_by_fd(vm::ptr<u32> ovlmid, u32 fd, u64 offset
 	}
 
 	std::lock_guard lock(file->mp->mutex);
+	reader_lock file_lock(file->mutex);
 
 	if (!file->file)
 	{
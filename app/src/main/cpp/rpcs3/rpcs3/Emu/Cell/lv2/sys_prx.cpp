@@ -419,6 +419,7 @@ error_code _sys_prx_load_module_by_fd(ppu_thread& ppu, s32 fd, u64 offset, u64 f
 	}
 
 	std::lock_guard lock(file->mp->mutex);
+	reader_lock file_lock(file->mutex);
 
 	if (!file->file)
 	{
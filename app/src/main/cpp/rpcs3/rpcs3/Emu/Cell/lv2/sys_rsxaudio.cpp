@@ -6,6 +6,7 @@
 //#include "Emu//Audio/audio_utils.h"
 #include "Emu//Cell/Modules/cellAudioOut.h"
 #include "util/video_provider.h"
+#include "util/simd.hpp"
 
 #include "sys_process.h"
 #include "sys_rsxaudio.h"
@@ -543,8 +544,144 @@ error_code sys_rsxaudio_get_dma_param(u32 handle, u32 flag, vm::ptr<u64> out)
 	return CELL_OK;
 }
 
-rsxaudio_data_container::rsxaudio_data_container(const rsxaudio_hw_param_t& hw_param, const buf_t& buf, bool serial_rdy, bool spdif_0_rdy, bool spdif_1_rdy) : hwp(hw_param), out_buf(buf)
+namespace
 {
+	// Converts contiguous big-endian PCM to float. RSX treats 20bit/24bit samples as 32bit ones.
+	void convert_pcm(RsxaudioSampleSize word_bits, const void* src, u32 sample_cnt, f32* dst)
+	{
+		u32 i = 0;
+
+		if (word_bits == RsxaudioSampleSize::_16BIT)
+		{
+			const auto in = static_cast<const be_t<s16>*>(src);
+
+			for (; i + 8 <= sample_cnt; i += 8)
+			{
+				// After swapping 32-bit words the first sample of each pair is in the upper half, i.e. already scaled by 1 << 16
+				const v128 pairs = gv_to_be32(v128::loadu(in + i));
+				const v128 even = gv_mulfs(gv_cvts32_tofs(gv_and32(pairs, gv_bcst32(0xffff0000))), 1.0f / 2147483648.0f);
+				const v128 odd = gv_mulfs(gv_cvts32_tofs(gv_shl32(pairs, 16)), 1.0f / 2147483648.0f);
+				v128::storeu(gv_unpacklo32(even, odd), dst + i);
+				v128::storeu(gv_unpackhi32(even, odd), dst + i + 4);
+			}
+
+			for (; i < sample_cnt; i++)
+			{
+				dst[i] = in[i] * (1.0f / 32768.0f);
+			}
+		}
+		else
+		{
+			const auto in = static_cast<const be_t<s32>*>(src);
+
+			for (; i + 4 <= sample_cnt; i += 4)
+			{
+				v128::storeu(gv_mulfs(gv_cvts32_tofs(gv_to_be32(v128::loadu(in + i))), 1.0f / 2147483648.0f), dst + i);
+			}
+
+			for (; i < sample_cnt; i++)
+			{
+				dst[i] = in[i] * (1.0f / 2147483648.0f);
+			}
+		}
+	}
+}
+
+template<usz output_ch_cnt>
+requires (output_ch_cnt > 0 && output_ch_cnt <= 8)
+void rsxaudio_data_container::mix(const std::array<u8, 8> &ch_map, RsxaudioSampleSize sample_size, RsxaudioPort port, data_blk_t& data_out)
+{
+	ensure(port == src_port);
+
+	const u32 word_sz = static_cast<u32>(sample_size);
+	const u32 samples_in_buf = sample_size == RsxaudioSampleSize::_16BIT ? SYS_RSXAUDIO_STREAM_SAMPLE_CNT * 2 : SYS_RSXAUDIO_STREAM_SAMPLE_CNT;
+
+	if (!src_addr)
+	{
+		std::fill_n(data_out.begin(), samples_in_buf * output_ch_cnt, 0.0f);
+		return;
+	}
+
+	const auto src = static_cast<const u8*>(src_addr);
+
+	if (port != RsxaudioPort::SERIAL)
+	{
+		// SPDIF data is already interleaved stereo
+		if (output_ch_cnt == SYS_RSXAUDIO_SPDIF_MAX_CH && ch_map[0] == 0 && ch_map[1] == 1)
+		{
+			convert_pcm(sample_size, src, samples_in_buf * SYS_RSXAUDIO_SPDIF_MAX_CH, data_out.data());
+			return;
+		}
+
+		alignas(16) f32 stereo[SYS_RSXAUDIO_STREAM_SAMPLE_CNT * 2 * SYS_RSXAUDIO_SPDIF_MAX_CH];
+		convert_pcm(sample_size, src, samples_in_buf * SYS_RSXAUDIO_SPDIF_MAX_CH, stereo);
+
+		for (u32 frame = 0; frame < samples_in_buf; frame++)
+		{
+			for (u32 ch = 0; ch < output_ch_cnt; ch++)
+			{
+				data_out[frame * output_ch_cnt + ch] = ch_map[ch] < SYS_RSXAUDIO_SPDIF_MAX_CH ? stereo[frame * SYS_RSXAUDIO_SPDIF_MAX_CH + ch_map[ch]] : 0.0f;
+			}
+		}
+
+		return;
+	}
+
+	// Serial streams hold a run of left samples followed by a run of right samples in every data block,
+	// so each mapped channel is converted one run at a time and then interleaved
+	const u32 run_len = (SYS_RSXAUDIO_DATA_BLK_SIZE / 2) / word_sz;
+	alignas(16) f32 runs[output_ch_cnt][SYS_RSXAUDIO_DATA_BLK_SIZE / 2 / sizeof(s16)];
+
+	for (u32 blk_idx = 0; blk_idx < SYS_RSXAUDIO_STREAM_DATA_BLK_CNT; blk_idx++)
+	{
+		for (u32 ch = 0; ch < output_ch_cnt; ch++)
+		{
+			const u8 in_ch = ch_map[ch];
+
+			if (in_ch >= SYS_RSXAUDIO_SERIAL_MAX_CH)
+			{
+				std::fill_n(runs[ch], run_len, 0.0f);
+				continue;
+			}
+
+			const u32 offset = blk_idx * SYS_RSXAUDIO_STREAM_SIZE + (in_ch / SYS_RSXAUDIO_CH_PER_STREAM) * SYS_RSXAUDIO_DATA_BLK_SIZE + (in_ch % SYS_RSXAUDIO_CH_PER_STREAM) * (SYS_RSXAUDIO_DATA_BLK_SIZE / 2);
+			convert_pcm(sample_size, src + offset, run_len, runs[ch]);
+		}
+
+		f32* const out = data_out.data() + blk_idx * run_len * output_ch_cnt;
+
+		if constexpr (output_ch_cnt == 2)
+		{
+			for (u32 i = 0; i < run_len; i += 4)
+			{
+				const v128 left = v128::loadu(runs[0] + i);
+				const v128 right = v128::loadu(runs[1] + i);
+				v128::storeu(gv_unpacklo32(left, right), out + i * 2);
+				v128::storeu(gv_unpackhi32(left, right), out + i * 2 + 4);
+			}
+		}
+		else
+		{
+			for (u32 i = 0; i < run_len; i++)
+			{
+				for (u32 ch = 0; ch < output_ch_cnt; ch++)
+				{
+					out[i * output_ch_cnt + ch] = runs[ch][i];
+				}
+			}
+		}
+	}
+}
+
+rsxaudio_data_container::rsxaudio_data_container(const rsxaudio_hw_param_t& hw_param, RsxaudioPort src_port, const void* src_addr)
+	: hwp(hw_param)
+	, src_port(src_port)
+	, src_addr(src_addr)
+{
+	const bool serial_rdy = src_port == RsxaudioPort::SERIAL;
+	const bool spdif_0_rdy = src_port == RsxaudioPort::SPDIF_0;
+	const bool spdif_1_rdy = src_port == RsxaudioPort::SPDIF_1;
+
 	if (serial_rdy)
 	{
 		avport_data_avail[static_cast<u8>(RsxaudioAvportIdx::AVMULTI)] = true;
@@ -685,16 +822,16 @@ void rsxaudio_data_container::get_data(RsxaudioAvportIdx avport, data_blk_t& dat
 			{
 				if (hwp.spdif[1].use_serial_buf)
 				{
-					mix<2>(spdif_filter_map(hdmi_idx), hwp.serial.depth, out_buf.serial, data_out);
+					mix<2>(spdif_filter_map(hdmi_idx), hwp.serial.depth, RsxaudioPort::SERIAL, data_out);
 				}
 				else
 				{
-					mix<2>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.spdif[1].depth, out_buf.spdif[1], data_out);
+					mix<2>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.spdif[1].depth, RsxaudioPort::SPDIF_1, data_out);
 				}
 			}
 			else
 			{
-				mix<2>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.serial.depth, out_buf.serial, data_out);
+				mix<2>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.serial.depth, RsxaudioPort::SERIAL, data_out);
 			}
 			break;
 		}
@@ -704,16 +841,16 @@ void rsxaudio_data_container::get_data(RsxaudioAvportIdx avport, data_blk_t& dat
 			{
 				if (hwp.spdif[1].use_serial_buf)
 				{
-					mix<6>(spdif_filter_map(hdmi_idx), hwp.serial.depth, out_buf.serial, data_out);
+					mix<6>(spdif_filter_map(hdmi_idx), hwp.serial.depth, RsxaudioPort::SERIAL, data_out);
 				}
 				else
 				{
-					mix<6>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.spdif[1].depth, out_buf.spdif[1], data_out);
+					mix<6>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.spdif[1].depth, RsxaudioPort::SPDIF_1, data_out);
 				}
 			}
 			else
 			{
-				mix<6>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.serial.depth, out_buf.serial, data_out);
+				mix<6>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.serial.depth, RsxaudioPort::SERIAL, data_out);
 			}
 			break;
 		}
@@ -723,16 +860,16 @@ void rsxaudio_data_container::get_data(RsxaudioAvportIdx avport, data_blk_t& dat
 			{
 				if (hwp.spdif[1].use_serial_buf)
 				{
-					mix<8>(spdif_filter_map(hdmi_idx), hwp.serial.depth, out_buf.serial, data_out);
+					mix<8>(spdif_filter_map(hdmi_idx), hwp.serial.depth, RsxaudioPort::SERIAL, data_out);
 				}
 				else
 				{
-					mix<8>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.spdif[1].depth, out_buf.spdif[1], data_out);
+					mix<8>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.spdif[1].depth, RsxaudioPort::SPDIF_1, data_out);
 				}
 			}
 			else
 			{
-				mix<8>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.serial.depth, out_buf.serial, data_out);
+				mix<8>(hwp.hdmi[hdmi_idx].ch_cfg.map, hwp.serial.depth, RsxaudioPort::SERIAL, data_out);
 			}
 			break;
 		}
@@ -742,7 +879,7 @@ void rsxaudio_data_container::get_data(RsxaudioAvportIdx avport, data_blk_t& dat
 	}
 	case RsxaudioAvportIdx::AVMULTI:
 	{
-		mix<2>({2, 3}, hwp.serial.depth, out_buf.serial, data_out);
+		mix<2>({2, 3}, hwp.serial.depth, RsxaudioPort::SERIAL, data_out);
 		break;
 	}
 	case RsxaudioAvportIdx::SPDIF_0:
@@ -752,11 +889,11 @@ void rsxaudio_data_container::get_data(RsxaudioAvportIdx avport, data_blk_t& dat
 
 		if (hwp.spdif[spdif_idx].use_serial_buf)
 		{
-			mix<2>({0, 1}, hwp.serial.depth, out_buf.serial, data_out);
+			mix<2>({0, 1}, hwp.serial.depth, RsxaudioPort::SERIAL, data_out);
 		}
 		else
 		{
-			mix<2>({0, 1}, hwp.spdif[spdif_idx].depth, out_buf.spdif[spdif_idx], data_out);
+			mix<2>({0, 1}, hwp.spdif[spdif_idx].depth, spdif_idx ? RsxaudioPort::SPDIF_1 : RsxaudioPort::SPDIF_0, data_out);
 		}
 		break;
 	}
@@ -1178,120 +1315,17 @@ bool rsxaudio_data_thread::calc_port_active_state(RsxaudioPort port, const rsxau
 	}
 }
 
-f32 rsxaudio_data_thread::pcm_to_float(s32 sample)
-{
-	return sample * (1.0f / 2147483648.0f);
-}
-
-f32 rsxaudio_data_thread::pcm_to_float(s16 sample)
-{
-	return sample * (1.0f / 32768.0f);
-}
-
-void rsxaudio_data_thread::pcm_serial_process_channel(RsxaudioSampleSize word_bits, ra_stream_blk_t& buf_out_l, ra_stream_blk_t& buf_out_r, const void* buf_in, u8 src_stream)
-{
-	const u8 input_word_sz = static_cast<u8>(word_bits);
-	u64 ch_dst = 0;
-
-	for (u64 blk_idx = 0; blk_idx < SYS_RSXAUDIO_STREAM_DATA_BLK_CNT; blk_idx++)
-	{
-		for (u64 offset = 0; offset < SYS_RSXAUDIO_DATA_BLK_SIZE / 2; offset += input_word_sz, ch_dst++)
-		{
-			const u64 left_ch_src = (blk_idx * SYS_RSXAUDIO_STREAM_SIZE + src_stream * SYS_RSXAUDIO_DATA_BLK_SIZE + offset) / input_word_sz;
-			const u64 right_ch_src = left_ch_src + (SYS_RSXAUDIO_DATA_BLK_SIZE / 2) / input_word_sz;
-
-			if (word_bits == RsxaudioSampleSize::_16BIT)
-			{
-				buf_out_l[ch_dst] = pcm_to_float(static_cast<const be_t<s16>*>(buf_in)[left_ch_src]);
-				buf_out_r[ch_dst] = pcm_to_float(static_cast<const be_t<s16>*>(buf_in)[right_ch_src]);
-			}
-			else
-			{
-				// Looks like rsx treats 20bit/24bit samples as 32bit ones
-				buf_out_l[ch_dst] = pcm_to_float(static_cast<const be_t<s32>*>(buf_in)[left_ch_src]);
-				buf_out_r[ch_dst] = pcm_to_float(static_cast<const be_t<s32>*>(buf_in)[right_ch_src]);
-			}
-		}
-	}
-}
-
-void rsxaudio_data_thread::pcm_spdif_process_channel(RsxaudioSampleSize word_bits, ra_stream_blk_t& buf_out_l, ra_stream_blk_t& buf_out_r, const void* buf_in)
-{
-	const u8 input_word_sz = static_cast<u8>(word_bits);
-
-	for (u64 offset = 0; offset < SYS_RSXAUDIO_RINGBUF_BLK_SZ_SPDIF / (input_word_sz * SYS_RSXAUDIO_SPDIF_MAX_CH); offset++)
-	{
-		const u64 left_ch_src = offset * SYS_RSXAUDIO_SPDIF_MAX_CH;
-		const u64 right_ch_src = left_ch_src + 1;
-
-		if (word_bits == RsxaudioSampleSize::_16BIT)
-		{
-			buf_out_l[offset] = pcm_to_float(static_cast<const be_t<s16>*>(buf_in)[left_ch_src]);
-			buf_out_r[offset] = pcm_to_float(static_cast<const be_t<s16>*>(buf_in)[right_ch_src]);
-		}
-		else
-		{
-			// Looks like rsx treats 20bit/24bit samples as 32bit ones
-			buf_out_l[offset] = pcm_to_float(static_cast<const be_t<s32>*>(buf_in)[left_ch_src]);
-			buf_out_r[offset] = pcm_to_float(static_cast<const be_t<s32>*>(buf_in)[right_ch_src]);
-		}
-	}
-}
-
 bool rsxaudio_data_thread::enqueue_data(RsxaudioPort dst, bool silence, const void* src_addr, const rsxaudio_hw_param_t& hwp)
 {
-	auto& backend_thread = g_fxo->get<rsx_audio_backend>();
-
-	if (dst == RsxaudioPort::SERIAL)
-	{
-		if (!silence)
-		{
-			for (u8 stream_idx = 0; stream_idx < SYS_RSXAUDIO_SERIAL_STREAM_CNT; stream_idx++)
-			{
-				pcm_serial_process_channel(hwp.serial.depth, output_buf.serial[stream_idx * 2], output_buf.serial[stream_idx * 2 + 1], src_addr, stream_idx);
-			}
-		}
-		else
-		{
-			output_buf.serial.fill({});
-		}
-
-		rsxaudio_data_container cont{hwp, output_buf, true, false, false};
-		backend_thread.add_data(cont);
-		return cont.data_was_used();
-	}
-	else if (dst == RsxaudioPort::SPDIF_0)
+	if (dst > RsxaudioPort::SPDIF_1)
 	{
-		if (!silence)
-		{
-			pcm_spdif_process_channel(hwp.spdif[0].depth, output_buf.spdif[0][0], output_buf.spdif[0][1], src_addr);
-		}
-		else
-		{
-			output_buf.spdif[0].fill({});
-		}
-
-		rsxaudio_data_container cont{hwp, output_buf, false, true, false};
-		backend_thread.add_data(cont);
-		return cont.data_was_used();
-	}
-	else if (dst == RsxaudioPort::SPDIF_1)
-	{
-		if (!silence)
-		{
-			pcm_spdif_process_channel(hwp.spdif[1].depth, output_buf.spdif[1][0], output_buf.spdif[1][1], src_addr);
-		}
-		else
-		{
-			output_buf.spdif[1].fill({});
-		}
-
-		rsxaudio_data_container cont{hwp, output_buf, false, false, true};
-		backend_thread.add_data(cont);
-		return cont.data_was_used();
+		return false;
 	}
 
-	return false;
+	// PCM is converted straight from the guest ringbuffer into the backend stream, and only for the selected avport
+	rsxaudio_data_container cont{hwp, dst, silence ? nullptr : src_addr};
+	g_fxo->get<rsx_audio_backend>().add_data(cont);
+	return cont.data_was_used();
 }
 
 namespace audio
@@ -1843,9 +1877,13 @@ u32 rsxaudio_backend_thread::write_data_callback(u32 bytes, void* buf)
 		const u32 bytes_ch_adjusted = bytes / output_ch_cnt * cb_cfg.input_ch_cnt;
 		const u32 bytes_from_rb = cb_cfg.convert_to_s16 ? bytes_ch_adjusted / static_cast<u32>(AudioSampleSize::S16) * static_cast<u32>(AudioSampleSize::FLOAT) : bytes_ch_adjusted;
 
-		ensure(callback_tmp_buf.size() * static_cast<u32>(AudioSampleSize::FLOAT) >= bytes_from_rb);
+		// Without downmixing or s16 conversion the stream can go straight into the backend buffer and be processed in place
+		const bool direct = !cb_cfg.convert_to_s16 && output_ch_cnt == cb_cfg.input_ch_cnt;
+		f32* const work_buf = direct ? static_cast<f32*>(buf) : callback_tmp_buf.data();
+
+		ensure(direct || callback_tmp_buf.size() * static_cast<u32>(AudioSampleSize::FLOAT) >= bytes_from_rb);
 
-		const u32 byte_cnt = static_cast<u32>(ringbuf.pop(callback_tmp_buf.data(), bytes_from_rb, true));
+		const u32 byte_cnt = static_cast<u32>(ringbuf.pop(work_buf, bytes_from_rb, true));
 		const u32 sample_cnt = byte_cnt / static_cast<u32>(AudioSampleSize::FLOAT);
 		const u32 sample_cnt_out = sample_cnt / cb_cfg.input_ch_cnt * output_ch_cnt;
 
@@ -1860,11 +1898,11 @@ u32 rsxaudio_backend_thread::write_data_callback(u32 bytes, void* buf)
 		if (g_recording_mode != recording_mode::stopped)
 		{
 			utils::video_provider& provider = g_fxo->get<utils::video_provider>();
-			provider.present_samples(reinterpret_cast<u8*>(callback_tmp_buf.data()), sample_cnt / cb_cfg.input_ch_cnt, cb_cfg.input_ch_cnt);
+			provider.present_samples(reinterpret_cast<u8*>(work_buf), sample_cnt / cb_cfg.input_ch_cnt, cb_cfg.input_ch_cnt);
 		}
 
 		// Downmix if necessary
-		AudioBackend::downmix(sample_cnt, cb_cfg.input_ch_cnt, output_channel_layout, callback_tmp_buf.data(), callback_tmp_buf.data());
+		AudioBackend::downmix(sample_cnt, cb_cfg.input_ch_cnt, output_channel_layout, work_buf, work_buf);
 
 		if (cb_cfg.target_volume != cb_cfg.current_volume)
 		{
@@ -1877,7 +1915,7 @@ u32 rsxaudio_backend_thread::write_data_callback(u32 bytes, void* buf)
 				.ch_cnt = cb_cfg.input_ch_cnt
 			};
 
-			const u16 new_vol = static_cast<u16>(std::round(AudioBackend::apply_volume(param, sample_cnt_out, callback_tmp_buf.data(), callback_tmp_buf.data()) * callback_config::VOL_NOMINAL));
+			const u16 new_vol = static_cast<u16>(std::round(AudioBackend::apply_volume(param, sample_cnt_out, work_buf, work_buf) * callback_config::VOL_NOMINAL));
 			callback_cfg.atomic_op([&](callback_config& val)
 			{
 				if (val.target_volume != cb_cfg.target_volume)
@@ -1891,16 +1929,16 @@ u32 rsxaudio_backend_thread::write_data_callback(u32 bytes, void* buf)
 		}
 		else if (cb_cfg.current_volume != callback_config::VOL_NOMINAL)
 		{
-			AudioBackend::apply_volume_static(cb_cfg.current_volume * callback_config::VOL_NOMINAL_INV, sample_cnt_out, callback_tmp_buf.data(), callback_tmp_buf.data());
+			AudioBackend::apply_volume_static(cb_cfg.current_volume * callback_config::VOL_NOMINAL_INV, sample_cnt_out, work_buf, work_buf);
 		}
 
 		if (cb_cfg.convert_to_s16)
 		{
-			AudioBackend::convert_to_s16(sample_cnt_out, callback_tmp_buf.data(), buf);
+			AudioBackend::convert_to_s16(sample_cnt_out, work_buf, buf);
 			return sample_cnt_out * static_cast<u32>(AudioSampleSize::S16);
 		}
 
-		AudioBackend::normalize(sample_cnt_out, callback_tmp_buf.data(), static_cast<f32*>(buf));
+		AudioBackend::normalize(sample_cnt_out, work_buf, static_cast<f32*>(buf));
 		return sample_cnt_out * static_cast<u32>(AudioSampleSize::FLOAT);
 	}
 
@@ -346,22 +346,16 @@ struct rsxaudio_hw_param_t
 	};
 };
 
-// 16-bit PCM converted into float, so buffer must be twice as big
-using ra_stream_blk_t = std::array<f32, SYS_RSXAUDIO_STREAM_SAMPLE_CNT * 2>;
-
 class rsxaudio_data_container
 {
 public:
 
-	struct buf_t
-	{
-		std::array<ra_stream_blk_t, SYS_RSXAUDIO_SERIAL_MAX_CH> serial{};
-		std::array<ra_stream_blk_t, SYS_RSXAUDIO_SPDIF_MAX_CH> spdif[SYS_RSXAUDIO_SPDIF_CNT]{};
-	};
-
+	// 16-bit PCM converted into float, so buffer must be twice as big
 	using data_blk_t = std::array<f32, SYS_RSXAUDIO_STREAM_SAMPLE_CNT * SYS_RSXAUDIO_SERIAL_MAX_CH * 2>;
 
-	rsxaudio_data_container(const rsxaudio_hw_param_t& hw_param, const buf_t& buf, bool serial_rdy, bool spdif_0_rdy, bool spdif_1_rdy);
+	// src_addr points to the guest ringbuffer block of src_port, nullptr means silence. PCM is converted straight
+	// from there into the interleaved output stream when get_data() is called, so the block must stay valid until then.
+	rsxaudio_data_container(const rsxaudio_hw_param_t& hw_param, RsxaudioPort src_port, const void* src_addr);
 	u32 get_data_size(RsxaudioAvportIdx avport);
 	void get_data(RsxaudioAvportIdx avport, data_blk_t& data_out);
 	bool data_was_used();
@@ -369,7 +363,8 @@ public:
 private:
 
 	const rsxaudio_hw_param_t& hwp;
-	const buf_t& out_buf;
+	const RsxaudioPort src_port;
+	const void* const src_addr;
 
 	std::array<bool, 5> avport_data_avail{};
 	u8 hdmi_stream_cnt[2]{};
@@ -381,43 +376,10 @@ private:
 	rsxaudio_data_container(rsxaudio_data_container&&) = delete;
 	rsxaudio_data_container& operator=(rsxaudio_data_container&&) = delete;
 
-	// Mix individual channels into final PCM stream. Channels in channel map that are > input_ch_cnt treated as silent.
-	template<usz output_ch_cnt, usz input_ch_cnt>
-	requires (output_ch_cnt > 0 && output_ch_cnt <= 8 && input_ch_cnt > 0)
-	constexpr void mix(const std::array<u8, 8> &ch_map, RsxaudioSampleSize sample_size, const std::array<ra_stream_blk_t, input_ch_cnt> &input_channels, data_blk_t& data_out)
-	{
-		const ra_stream_blk_t silent_channel{};
-
-		// Build final map
-		std::array<const ra_stream_blk_t*, output_ch_cnt> real_input_ch = {};
-		for (u64 ch_idx = 0; ch_idx < output_ch_cnt; ch_idx++)
-		{
-			if (ch_map[ch_idx] >= input_ch_cnt)
-			{
-				real_input_ch[ch_idx] = &silent_channel;
-			}
-			else
-			{
-				real_input_ch[ch_idx] = &input_channels[ch_map[ch_idx]];
-			}
-		}
-
-		const u32 samples_in_buf = sample_size == RsxaudioSampleSize::_16BIT ? SYS_RSXAUDIO_STREAM_SAMPLE_CNT * 2 : SYS_RSXAUDIO_STREAM_SAMPLE_CNT;
-
-		for (u32 sample_idx = 0; sample_idx < samples_in_buf * output_ch_cnt; sample_idx += output_ch_cnt)
-		{
-			const u32 src_sample_idx = sample_idx / output_ch_cnt;
-
-			if constexpr (output_ch_cnt >= 1) data_out[sample_idx + 0] = (*real_input_ch[0])[src_sample_idx];
-			if constexpr (output_ch_cnt >= 2) data_out[sample_idx + 1] = (*real_input_ch[1])[src_sample_idx];
-			if constexpr (output_ch_cnt >= 3) data_out[sample_idx + 2] = (*real_input_ch[2])[src_sample_idx];
-			if constexpr (output_ch_cnt >= 4) data_out[sample_idx + 3] = (*real_input_ch[3])[src_sample_idx];
-			if constexpr (output_ch_cnt >= 5) data_out[sample_idx + 4] = (*real_input_ch[4])[src_sample_idx];
-			if constexpr (output_ch_cnt >= 6) data_out[sample_idx + 5] = (*real_input_ch[5])[src_sample_idx];
-			if constexpr (output_ch_cnt >= 7) data_out[sample_idx + 6] = (*real_input_ch[6])[src_sample_idx];
-			if constexpr (output_ch_cnt >= 8) data_out[sample_idx + 7] = (*real_input_ch[7])[src_sample_idx];
-		}
-	}
+	// Mix individual channels of the port into final PCM stream. Channels in channel map that are >= channel count of the port treated as silent.
+	template<usz output_ch_cnt>
+	requires (output_ch_cnt > 0 && output_ch_cnt <= 8)
+	void mix(const std::array<u8, 8> &ch_map, RsxaudioSampleSize sample_size, RsxaudioPort port, data_blk_t& data_out);
 };
 
 namespace audio
@@ -599,8 +561,6 @@ public:
 
 private:
 
-	rsxaudio_data_container::buf_t output_buf{};
-
 	transactional_storage<rsxaudio_hw_param_t> hw_param_ts{std::make_shared<universal_pool>(), std::make_shared<rsxaudio_hw_param_t>()};
 	rsxaudio_periodic_tmr timer{};
 
@@ -608,10 +568,6 @@ private:
 	void extract_audio_data();
 	static std::pair<bool /*data_present*/, void* /*addr*/> get_ringbuf_addr(RsxaudioPort dst, const lv2_rsxaudio& rsxaudio_obj);
 
-	static f32 pcm_to_float(s32 sample);
-	static f32 pcm_to_float(s16 sample);
-	static void pcm_serial_process_channel(RsxaudioSampleSize word_bits, ra_stream_blk_t& buf_out_l, ra_stream_blk_t& buf_out_r, const void* buf_in, u8 src_stream);
-	static void pcm_spdif_process_channel(RsxaudioSampleSize word_bits, ra_stream_blk_t& buf_out_l, ra_stream_blk_t& buf_out_r, const void* buf_in);
 	bool enqueue_data(RsxaudioPort dst, bool silence, const void* src_addr, const rsxaudio_hw_param_t& hwp);
 
 	static rsxaudio_backend_thread::avport_bit calc_avport_mute_state(const rsxaudio_hw_param_t& hwp);
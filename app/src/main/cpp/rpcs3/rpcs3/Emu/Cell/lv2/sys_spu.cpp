@@ -549,6 +549,7 @@ error_code sys_spu_image_open_by_fd(ppu_thread& ppu, vm::ptr<sys_spu_image> img,
 	}
 
 	std::lock_guard lock(file->mp->mutex);
+	reader_lock file_lock(file->mutex);
 
 	if (!file->file)
 	{
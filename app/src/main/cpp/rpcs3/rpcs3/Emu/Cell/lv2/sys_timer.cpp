@@ -7,6 +7,7 @@
 #include "Emu/Cell/timers.hpp"
 
 #include "util/asm.hpp"
+#include "util/timer_wheel.hpp"
 #include "Emu/System.h"
 #include "Emu/system_config.h"
 #include "sys_event.h"
@@ -17,14 +18,23 @@
 
 LOG_CHANNEL(sys_timer);
 
+// Timers expiring within the same window share a host wakeup (they may fire late by up to this many microseconds, never early)
+constexpr u64 timer_coalesce_window = 32;
+
 struct lv2_timer_thread
 {
 	shared_mutex mutex;
 	std::deque<shared_ptr<lv2_timer>> timers;
 
+	// Expiration times of running timers, entries not matching lv2_timer::wheel_expire are stale and ignored
+	utils::timer_wheel<shared_ptr<lv2_timer>> wheel;
+
 	lv2_timer_thread();
 	void operator()();
 
+	// Must be called with the mutex held
+	void schedule(const shared_ptr<lv2_timer>& timer, u64 expire);
+
 	//SAVESTATE_INIT_POS(46); // FREE SAVESTATE_INIT_POS number
 
 	static constexpr auto thread_name = "Timer Thread"sv;
@@ -107,13 +117,34 @@ lv2_timer_thread::lv2_timer_thread()
 {
 	Emu.PostponeInitCode([this]()
 	{
-		idm::select<lv2_obj, lv2_timer>([&](u32 id, lv2_timer&)
+		idm::select<lv2_obj, lv2_timer>([&](u32 id, lv2_timer& timer)
 		{
 			timers.emplace_back(idm::get_unlocked<lv2_obj, lv2_timer>(id));
+
+			if (timer.state == SYS_TIMER_STATE_RUN)
+			{
+				schedule(timers.back(), timer.expire);
+			}
 		});
 	});
 }
 
+void lv2_timer_thread::schedule(const shared_ptr<lv2_timer>& timer, u64 expire)
+{
+	if (timer->wheel_expire == expire)
+	{
+		return;
+	}
+
+	if (timer->wheel_expire != umax)
+	{
+		wheel.erase(timer->wheel_expire, timer);
+	}
+
+	wheel.insert(expire, timer);
+	timer->wheel_expire = expire;
+}
+
 void lv2_timer_thread::operator()()
 {
 	u64 sleep_time = 0;
@@ -143,10 +174,18 @@ void lv2_timer_thread::operator()()
 
 		const u64 _now = get_guest_system_time();
 
-		reader_lock lock(mutex);
+		std::lock_guard lock(mutex);
 
-		for (const auto& timer : timers)
+		// Only timers which are due are visited
+		wheel.advance(_now, [&](u64 deadline, shared_ptr<lv2_timer>& timer)
 		{
+			if (timer->wheel_expire != deadline)
+			{
+				return;
+			}
+
+			timer->wheel_expire = umax;
+
 			while (lv2_obj::check(timer))
 			{
 				if (thread_ctrl::state() == thread_state::aborting)
@@ -156,14 +195,26 @@ void lv2_timer_thread::operator()()
 
 				if (const u64 advised_sleep_time = timer->check(_now))
 				{
-					if (sleep_time > advised_sleep_time)
+					if (advised_sleep_time != umax)
 					{
-						sleep_time = advised_sleep_time;
+						schedule(timer, _now + advised_sleep_time);
 					}
 
 					break;
 				}
 			}
+		});
+
+		if (const u64 next = wheel.next_deadline(); next != umax)
+		{
+			u64 wake_time = next;
+
+			if (g_cfg.core.sleep_timers_accuracy < sleep_timers_accuracy_level::_all_timers)
+			{
+				wake_time = utils::align(next, timer_coalesce_window);
+			}
+
+			sleep_time = utils::sub_saturate<u64>(wake_time, _now);
 		}
 	}
 }
@@ -230,6 +281,12 @@ error_code sys_timer_destroy(ppu_thread& ppu, u32 timer_id)
 		thread.timers.erase(it);
 	}
 
+	if (timer.ptr->wheel_expire != umax)
+	{
+		thread.wheel.erase(timer.ptr->wheel_expire, timer.ptr);
+		timer.ptr->wheel_expire = umax;
+	}
+
 	return CELL_OK;
 }
 
@@ -274,7 +331,7 @@ error_code _sys_timer_start(ppu_thread& ppu, u32 timer_id, u64 base_time, u64 pe
 		return CELL_EINVAL;
 	}
 
-	const auto timer = idm::check<lv2_obj, lv2_timer>(timer_id, [&](lv2_timer& timer) -> CellError
+	const auto timer = idm::get<lv2_obj, lv2_timer>(timer_id, [&](lv2_timer& timer) -> CellError
 	{
 		std::lock_guard lock(timer.mutex);
 
@@ -334,7 +391,18 @@ error_code _sys_timer_start(ppu_thread& ppu, u32 timer_id, u64 base_time, u64 pe
 		return timer.ret;
 	}
 
-	g_fxo->get<named_thread<lv2_timer_thread>>()([]{});
+	auto& thread = g_fxo->get<named_thread<lv2_timer_thread>>();
+	{
+		std::lock_guard lock(thread.mutex);
+
+		// Read again as the timer may have fired or been restarted meanwhile
+		if (timer.ptr->state == SYS_TIMER_STATE_RUN)
+		{
+			thread.schedule(timer.ptr, timer.ptr->expire);
+		}
+	}
+
+	thread([]{});
 
 	return CELL_OK;
 }
@@ -36,6 +36,8 @@ struct lv2_timer : lv2_obj
 	atomic_t<u64> expire{0}; // Next expiration time
 	atomic_t<u64> period{0}; // Period (oneshot if 0)
 
+	u64 wheel_expire = umax; // Deadline of the entry in the timer thread wheel (protected by its mutex)
+
 	u64 check(u64 _now) noexcept;
 	u64 check_unlocked(u64 _now) noexcept;
 
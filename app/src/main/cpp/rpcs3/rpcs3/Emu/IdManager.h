@@ -64,6 +64,19 @@ namespace id_manager
 		return T::id_lowest;
 	}
 
+	// Types whose objects are never accessed under g_mutex by code outside of idm may be locked by their own map instead
+	template <typename T>
+	consteval bool get_uses_own_lock()
+	{
+		return false;
+	}
+
+	template <typename T> requires requires () { bool{T::id_own_lock}; }
+	consteval bool get_uses_own_lock()
+	{
+		return T::id_own_lock;
+	}
+
 	// Last allocated ID for constructors
 	extern thread_local u32 g_id;
 
@@ -288,10 +301,22 @@ namespace id_manager
 		std::array<id_key, T::id_count> vec_keys{};
 		u32 highest_index = 0;
 
-		shared_mutex mutex{}; // TODO: Use this instead of global mutex
+		shared_mutex mutex{}; // Used instead of g_mutex if T declares id_own_lock
 
 		id_map() noexcept = default;
 
+		shared_mutex& get_mutex() noexcept
+		{
+			if constexpr (get_uses_own_lock<T>())
+			{
+				return mutex;
+			}
+			else
+			{
+				return g_mutex;
+			}
+		}
+
 		// Order it directly before the source type's position
 		static constexpr double savestate_init_pos_original = T::savestate_init_pos;
 		static constexpr double savestate_init_pos = std::bit_cast<double>(std::bit_cast<u64>(savestate_init_pos_original) - 1);
@@ -380,7 +405,7 @@ namespace id_manager
 		{
 			if (highest_index)
 			{
-				reader_lock lock(g_mutex);
+				reader_lock lock(get_mutex());
 
 				// Save all entries
 				for (u32 i = 0; i < highest_index; i++)
@@ -488,6 +513,20 @@ class idm
 		return id_manager::typeinfo::get_type<T>();
 	}
 
+	// Get the mutex protecting the container of T (id_manager::g_mutex unless T declares id_own_lock)
+	template <typename T>
+	static shared_mutex& get_mutex()
+	{
+		if constexpr (id_manager::get_uses_own_lock<T>())
+		{
+			return g_fxo->get<id_manager::id_map<T>>().mutex;
+		}
+		else
+		{
+			return id_manager::g_mutex;
+		}
+	}
+
 	// Prepare new ID (returns nullptr if out of resources)
 	static id_manager::id_key* allocate_id(std::span<id_manager::id_key> keys, u32& highest_index, u32 type_id, u32 dst_id, u32 base, u32 step, u32 count, bool uses_lowest_id, std::pair<u32, u32> invl_range);
 
@@ -544,11 +583,11 @@ class idm
 		// Ensure make_typeinfo() is used for this type
 		[[maybe_unused]] auto& td = stx::typedata<id_manager::typeinfo, Type>();
 
-		// Allocate new id
-		std::lock_guard lock(id_manager::g_mutex);
-
 		auto& map = g_fxo->get<id_manager::id_map<T>>();
 
+		// Allocate new id
+		std::lock_guard lock(map.get_mutex());
+
 		if (auto* key_ptr = allocate_id({map.vec_keys.data(), map.vec_keys.size()}, map.highest_index, get_type<Type>(), id, traits::base, traits::step, traits::count, traits::uses_lowest_id, traits::invl_range))
 		{
 			auto& place = map.vec_data[key_ptr - map.vec_keys.data()];
@@ -572,7 +611,7 @@ public:
 	template <typename T>
 	static inline void clear()
 	{
-		std::lock_guard lock(id_manager::g_mutex);
+		std::lock_guard lock(get_mutex<T>());
 
 		for (auto& ptr : g_fxo->get<id_manager::id_map<T>>().vec_data)
 		{
@@ -661,7 +700,7 @@ public:
 			return {};
 		}
 
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_mutex<T>());
 
 		if (const auto found = find_index<T, Get>(index, id); found.first)
 		{
@@ -708,7 +747,7 @@ public:
 			return {};
 		}
 
-		reader_lock lock(id_manager::g_mutex);
+		reader_lock lock(get_mutex<T>());
 
 		const auto found = find_index<T, Get>(index, id);
 
@@ -741,7 +780,7 @@ public:
 	{
 		static_assert((IdmTypesCompatible<T, Get> && ...), "Invalid ID type combination");
 
-		[[maybe_unused]] std::conditional_t<!!Lock(), reader_lock, const shared_mutex&> lock(id_manager::g_mutex);
+		[[maybe_unused]] std::conditional_t<!!Lock(), reader_lock, const shared_mutex&> lock(get_mutex<T>());
 
 		using func_traits = function_traits<decltype(&decltype(std::function(std::declval<F>()))::operator())>;
 		using object_type = typename func_traits::object_type;
@@ -788,7 +827,7 @@ public:
 	{
 		stx::shared_ptr<T> ptr;
 		{
-			std::lock_guard lock(id_manager::g_mutex);
+			std::lock_guard lock(get_mutex<T>());
 
 			if (const auto found = find_id<T, Get>(id); found.first)
 			{
@@ -820,7 +859,7 @@ public:
 	{
 		stx::shared_ptr<T> ptr;
 		{
-			[[maybe_unused]] std::conditional_t<!!Lock(), std::lock_guard<shared_mutex>, const shared_mutex&> lock(id_manager::g_mutex);
+			[[maybe_unused]] std::conditional_t<!!Lock(), std::lock_guard<shared_mutex>, const shared_mutex&> lock(get_mutex<T>());
 
 			if (const auto found = find_id<T, Get>(id); found.first && found.first->is_equal(sptr))
 			{
@@ -852,7 +891,7 @@ public:
 	{
 		stx::shared_ptr<Get> ptr;
 		{
-			[[maybe_unused]] std::conditional_t<!!Lock(), std::lock_guard<shared_mutex>, const shared_mutex&> lock(id_manager::g_mutex);
+			[[maybe_unused]] std::conditional_t<!!Lock(), std::lock_guard<shared_mutex>, const shared_mutex&> lock(get_mutex<T>());
 
 			if (const auto found = find_id<T, Get>(id); found.first)
 			{
@@ -876,7 +915,7 @@ public:
 			return {};
 		}
 
-		std::unique_lock lock(id_manager::g_mutex);
+		std::unique_lock lock(get_mutex<T>());
 
 		if (const auto found = find_index<T, Get>(index, id); found.first)
 		{
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Emu/Memory/vm.h"
 #include "TextureUtils.h"
+#include "texture_disk_cache.h"
 #include "../RSXThread.h"
 #include "../rsx_utils.h"
 #include "3rdparty/bcdec/bcdec.hpp"
@@ -698,6 +699,24 @@ namespace
 		return result;
 	}
 
+	/**
+	 * Compressed 3D textures use the VTC block arrangement which the compute decoder does not understand.
+	 * Padded rows (mipmaps of linear textures keep the pitch of mip 0) or borders would need one deferred copy per row,
+	 * and the scratch copy in upload_image only handles a single packed copy.
+	 * Those are rare enough to keep going through the CPU path. Uploads check the whole image with can_gpu_decode_bc_image,
+	 * the decode pass in upload_image works on all regions of an image at once and cannot mix in CPU decoded levels.
+	 */
+	bool can_decode_bc_with_gpu(const rsx::subresource_layout& src_layout)
+	{
+		if (src_layout.pitch_in_block != src_layout.width_in_block || src_layout.border)
+		{
+			return false;
+		}
+
+		const bool is_po2 = utils::is_power_of_2(src_layout.width_in_texel) && utils::is_power_of_2(src_layout.height_in_texel);
+		return src_layout.depth == 1 || !is_po2;
+	}
+
 	/**
 	 * Texture upload template.
 	 *
@@ -946,7 +965,7 @@ namespace rsx
 		return get_subresources_layout_impl(texture);
 	}
 
-	texture_memory_info upload_texture_subresource_with_cpu(rsx::io_buffer& dst_buffer, const rsx::subresource_layout& src_layout, int format, bool is_swizzled, texture_uploader_capabilities& caps)
+	static texture_memory_info upload_texture_subresource_with_cpu_impl(rsx::io_buffer& dst_buffer, const rsx::subresource_layout& src_layout, int format, bool is_swizzled, texture_uploader_capabilities& caps)
 	{
 		u16 w = src_layout.width_in_block;
 		u16 h = src_layout.height_in_block;
@@ -1407,6 +1426,25 @@ namespace rsx
 		return result;
 	}
 
+	texture_memory_info upload_texture_subresource_with_cpu(rsx::io_buffer& dst_buffer, const rsx::subresource_layout& src_layout, int format, bool is_swizzled, texture_uploader_capabilities& caps)
+	{
+		const u64 cache_key = texture_disk_cache::get_key(src_layout, format, is_swizzled, caps);
+
+		if (texture_memory_info result{}; cache_key && texture_disk_cache::load(cache_key, dst_buffer, result))
+		{
+			return result;
+		}
+
+		auto result = upload_texture_subresource_with_cpu_impl(dst_buffer, src_layout, format, is_swizzled, caps);
+
+		if (cache_key)
+		{
+			texture_disk_cache::store(cache_key, dst_buffer, result);
+		}
+
+		return result;
+	}
+
     texture_memory_info upload_texture_subresource_with_gpu(rsx::io_buffer& dst_buffer, const rsx::subresource_layout& src_layout, int format, bool is_swizzled, texture_uploader_capabilities& caps)
     {
         u16 w = src_layout.width_in_block;
@@ -1642,8 +1680,15 @@ namespace rsx
                 break;
 #else
                 if (!caps.supports_dxt)
-                    //FIXME 转换为GPU操作
-                    return upload_texture_subresource_with_cpu(dst_buffer, src_layout, format, is_swizzled, caps);
+                {
+                    if (!can_decode_bc_with_gpu(src_layout))
+                        return upload_texture_subresource_with_cpu(dst_buffer, src_layout, format, is_swizzled, caps);
+
+                    // Upload the blocks tightly packed, they are expanded by a compute pass
+                    result.require_mth=texture_memory_info_require_mth::upload|texture_memory_info_require_mth::decode_bc1;
+                    result.deferred_cmds= build_transfer_cmds(src_layout.data.data(),8,w,h,depth,0,w,src_layout.pitch_in_block);
+                    break;
+                }
                 result.require_mth=texture_memory_info_require_mth::upload;
                 result.deferred_cmds= build_transfer_cmds(src_layout.data.data(),8,w,h,depth,0,get_row_pitch_in_block<u32>(w, caps.alignment),src_layout.pitch_in_block);
 
@@ -1654,8 +1699,14 @@ namespace rsx
             case CELL_GCM_TEXTURE_COMPRESSED_DXT23:
             {
                 if (!caps.supports_dxt)
-                    //FIXME 转换为GPU操作
-                    return upload_texture_subresource_with_cpu(dst_buffer, src_layout, format, is_swizzled, caps);
+                {
+                    if (!can_decode_bc_with_gpu(src_layout))
+                        return upload_texture_subresource_with_cpu(dst_buffer, src_layout, format, is_swizzled, caps);
+
+                    result.require_mth=texture_memory_info_require_mth::upload|texture_memory_info_require_mth::decode_bc2;
+                    result.deferred_cmds= build_transfer_cmds(src_layout.data.data(),16,w,h,depth,0,w,src_layout.pitch_in_block);
+                    break;
+                }
                 result.require_mth=texture_memory_info_require_mth::upload;
                 result.deferred_cmds= build_transfer_cmds(src_layout.data.data(),16,w,h,depth,0,get_row_pitch_in_block<u32>(w, caps.alignment),src_layout.pitch_in_block);
 
@@ -1663,10 +1714,15 @@ namespace rsx
             }
             case CELL_GCM_TEXTURE_COMPRESSED_DXT45:
             {
-
                 if (!caps.supports_dxt)
-                    //FIXME 转换为GPU操作
-                    return upload_texture_subresource_with_cpu(dst_buffer, src_layout, format, is_swizzled, caps);
+                {
+                    if (!can_decode_bc_with_gpu(src_layout))
+                        return upload_texture_subresource_with_cpu(dst_buffer, src_layout, format, is_swizzled, caps);
+
+                    result.require_mth=texture_memory_info_require_mth::upload|texture_memory_info_require_mth::decode_bc3;
+                    result.deferred_cmds= build_transfer_cmds(src_layout.data.data(),16,w,h,depth,0,w,src_layout.pitch_in_block);
+                    break;
+                }
                 result.require_mth=texture_memory_info_require_mth::upload;
                 result.deferred_cmds= build_transfer_cmds(src_layout.data.data(),16,w,h,depth,0,get_row_pitch_in_block<u32>(w, caps.alignment),src_layout.pitch_in_block);
 
@@ -1680,6 +1736,11 @@ namespace rsx
         return result;
     }
 
+	bool can_gpu_decode_bc_image(const std::vector<subresource_layout>& subresources)
+	{
+		return std::all_of(subresources.begin(), subresources.end(), FN(can_decode_bc_with_gpu(x)));
+	}
+
     bool is_compressed_host_format(const texture_uploader_capabilities& caps, u32 texture_format)
 	{
 		switch (texture_format)
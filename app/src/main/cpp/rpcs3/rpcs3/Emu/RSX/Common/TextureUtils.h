@@ -260,6 +260,9 @@ namespace rsx
 	texture_memory_info upload_texture_subresource_with_cpu(rsx::io_buffer& dst_buffer, const subresource_layout &src_layout, int format, bool is_swizzled, texture_uploader_capabilities& caps);
     texture_memory_info upload_texture_subresource_with_gpu(rsx::io_buffer& dst_buffer, const subresource_layout &src_layout, int format, bool is_swizzled, texture_uploader_capabilities& caps);
 
+	// True if every subresource of a DXT image can be expanded by the compute decoder (no padded rows, borders or VTC layout)
+	bool can_gpu_decode_bc_image(const std::vector<subresource_layout>& subresources);
+
 	u8 get_format_block_size_in_bytes(int format);
 	u8 get_format_block_size_in_texel(int format);
 	u8 get_format_block_size_in_bytes(rsx::surface_color_format format);
@@ -57,6 +57,7 @@ protected:
 	usz m_min_guard_size; //If an allocation touches the guard region, reset the heap to avoid going over budget
 	usz m_current_allocated_size;
 	usz m_largest_allocated_pool;
+	usz m_peak_allocated_size = 0; // Highest occupancy since the last call to reset_peak_allocated_size
 
 	char* m_name;
 public:
@@ -96,6 +97,7 @@ public:
 		const usz block_length = (aligned_put_pos - m_put_pos) + alloc_size;
 		m_current_allocated_size += block_length;
 		m_largest_allocated_pool = std::max(m_largest_allocated_pool, block_length);
+		m_peak_allocated_size = std::max(m_peak_allocated_size, m_current_allocated_size);
 
 		if (aligned_put_pos + alloc_size < m_size)
 		{
@@ -147,4 +149,11 @@ public:
 	{
 		return m_size;
 	}
+
+	usz reset_peak_allocated_size()
+	{
+		const usz result = std::max(m_peak_allocated_size, m_current_allocated_size);
+		m_peak_allocated_size = 0;
+		return result;
+	}
 };
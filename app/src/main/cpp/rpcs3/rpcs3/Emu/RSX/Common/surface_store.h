@@ -20,6 +20,18 @@ namespace rsx
 		usz get_packed_pitch(surface_color_format format, u32 width);
 	}
 
+	struct surface_pool_stats_t
+	{
+		u64 pooled_allocations = 0; // Requests satisfied by recycling an invalidated surface
+		u64 fresh_allocations = 0;  // Requests that required a new surface
+
+		u32 get_pooled_percentage() const
+		{
+			const u64 total = pooled_allocations + fresh_allocations;
+			return total ? static_cast<u32>((pooled_allocations * 100) / total) : 0;
+		}
+	};
+
 	template <typename Traits>
 	struct surface_store
 	{
@@ -80,6 +92,9 @@ namespace rsx
 		// Amount of virtual PS3 memory tied to allocated textures
 		u64 m_active_memory_used = 0;
 
+		// Surface allocation statistics
+		surface_pool_stats_t m_pool_stats = {};
+
 		surface_store() = default;
 		~surface_store() = default;
 		surface_store(const surface_store&) = delete;
@@ -515,6 +530,7 @@ namespace rsx
 						Traits::invalidate_surface_contents(command_list, new_surface, format, address, pitch);
 						Traits::prepare_surface_for_drawing(command_list, new_surface);
 						allocate_rsx_memory(new_surface);
+						m_pool_stats.pooled_allocations++;
 						break;
 					}
 				}
@@ -534,6 +550,7 @@ namespace rsx
 				new_surface = Traits::get(new_surface_storage);
 				Traits::prepare_surface_for_drawing(command_list, new_surface);
 				allocate_rsx_memory(new_surface);
+				m_pool_stats.fresh_allocations++;
 			}
 
 			// Remove and preserve if possible any overlapping/replaced surface from the other pool
@@ -0,0 +1,564 @@
+#include "stdafx.h"
+#include "texture_disk_cache.h"
+
+#include "Emu/cache_utils.hpp"
+#include "Emu/IdManager.h"
+#include "Emu/memory_governor.hpp"
+#include "Emu/system_config.h"
+#include "Emu/RSX/gcm_enums.h"
+
+#include "Utilities/File.h"
+#include "Utilities/lockless.h"
+#include "Utilities/mutex.h"
+#include "Utilities/Thread.h"
+
+#include "util/fnv_hash.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "xxhash.h"
+
+namespace rsx::texture_disk_cache
+{
+	namespace
+	{
+		constexpr u32 cache_magic = "TXC1"_u32;
+		constexpr u32 cache_version = 1;
+
+		// Below this size hashing and the file round trip cost about as much as redoing the transform
+		constexpr u32 min_payload_size = 0x10000;
+
+		// Payloads waiting for the writer are dropped beyond this, a slow disk must not turn into a memory leak
+		constexpr u64 max_queued_bytes = 64 * 0x100000;
+
+		// Files read ahead by the thread so that hits never touch the disk on the RSX thread.
+		// Half of it is filled with the most recently used entries on startup.
+		constexpr u64 max_prefetched_bytes = 128 * 0x100000;
+
+		struct file_header_t
+		{
+			u32 magic;
+			u32 version;
+			u64 key;
+			u32 payload_size;
+			s32 element_size;
+			s32 block_length;
+			u32 require_mth;
+		};
+
+		struct key_desc_t
+		{
+			u32 format;
+			u16 width_in_texel;
+			u16 height_in_texel;
+			u16 width_in_block;
+			u16 height_in_block;
+			u16 depth;
+			u8 border;
+			u8 is_swizzled;
+			u32 pitch_in_block;
+			u32 alignment;
+			u8 supports_byteswap;
+			u8 supports_hw_deswizzle;
+			u8 supports_dxt;
+			u8 use_bgra;
+			u32 version;
+		};
+
+		// Hashed as raw bytes, there must not be any padding
+		static_assert(std::has_unique_object_representations_v<key_desc_t>);
+
+		enum class job_type : u8
+		{
+			write,
+			touch, // Refresh the file timestamp after a hit
+			prefetch,
+		};
+
+		struct cache_job_t
+		{
+			job_type type;
+			u64 key;
+			file_header_t header;
+			std::vector<u8> payload;
+		};
+
+		struct cache_entry_t
+		{
+			u64 size;
+			std::list<u64>::iterator lru;
+		};
+
+		struct cache_thread
+		{
+			shared_mutex m_mutex;
+			std::unordered_map<u64, cache_entry_t> m_entries;
+			std::list<u64> m_lru; // Most recently used first
+			std::unordered_set<u64> m_pending;
+			std::unordered_map<u64, std::vector<u8>> m_prefetched; // Whole files, consumed by the next hit
+			std::unordered_set<u64> m_prefetch_requests;
+			std::string m_root_path;
+			u64 m_total_size = 0;
+			atomic_t<bool> m_ready = false; // Set by the thread once the directory has been scanned
+
+			lf_queue<cache_job_t> m_queue;
+			atomic_t<u64> m_queued_bytes = 0;
+			atomic_t<u64> m_prefetched_bytes = 0;
+			u32 m_pool_id = 0;
+
+			atomic_t<u64> m_hits = 0;
+			atomic_t<u64> m_misses = 0;
+			atomic_t<u64> m_stores = 0;
+			atomic_t<u64> m_evictions = 0;
+
+			static constexpr auto thread_name = "RSX Texture Disk Cache"sv;
+
+			cache_thread()
+			{
+				if (!g_cfg.video.texture_disk_cache)
+				{
+					return;
+				}
+
+				m_pool_id = rpcs3::memory_governor::register_pool({ "Texture disk cache (pending)", rpcs3::memory_governor::pool_priority::host_cache,
+					[this]() { return m_queued_bytes + m_prefetched_bytes; },
+					[this](rpcs3::memory_governor::pressure_level)
+					{
+						// Prefetched files can be read again, queued writes are not dropped
+						std::lock_guard lock(m_mutex);
+						const u64 old_size = m_prefetched_bytes;
+						m_prefetched.clear();
+						m_prefetched_bytes = 0;
+						return old_size;
+					} });
+			}
+
+			~cache_thread()
+			{
+				if (m_pool_id)
+				{
+					rpcs3::memory_governor::unregister_pool(m_pool_id);
+				}
+			}
+
+			std::string get_path(u64 key) const
+			{
+				return fmt::format("%s%016llx.tex", m_root_path, key);
+			}
+
+			// Scans the cache directory, called once by the thread
+			bool initialize()
+			{
+				std::lock_guard lock(m_mutex);
+
+				if (std::string cache_path = rpcs3::cache::get_ppu_cache(); !cache_path.empty())
+				{
+					m_root_path = std::move(cache_path) + "texture_cache/";
+				}
+
+				if (m_root_path.empty() || !fs::create_path(m_root_path))
+				{
+					rsx_log.error("Texture disk cache could not be created at '%s'", m_root_path);
+					m_root_path.clear();
+					return false;
+				}
+
+				std::vector<std::pair<s64, u64>> found; // mtime, key
+
+				for (const auto& entry : fs::dir(m_root_path))
+				{
+					if (entry.is_directory || !entry.name.ends_with(".tex"))
+					{
+						continue;
+					}
+
+					u64 key = 0;
+					const std::string_view stem = std::string_view(entry.name).substr(0, entry.name.size() - 4);
+					if (const auto [ptr, ec] = std::from_chars(stem.data(), stem.data() + stem.size(), key, 16);
+						ec != std::errc{} || ptr != stem.data() + stem.size())
+					{
+						continue;
+					}
+
+					if (m_entries.try_emplace(key, cache_entry_t{ entry.size }).second)
+					{
+						found.emplace_back(entry.mtime, key);
+						m_total_size += entry.size;
+					}
+				}
+
+				// Timestamps are refreshed on hits, so they give the LRU order of previous sessions
+				std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+				for (const auto& [mtime, key] : found)
+				{
+					m_lru.push_back(key);
+					m_entries[key].lru = std::prev(m_lru.end());
+				}
+
+				m_ready = true;
+
+				rsx_log.notice("Texture disk cache: %u entries (%llu KiB) in '%s'", m_entries.size(), m_total_size / 1024, m_root_path);
+				return true;
+			}
+
+			// Must be called with the lock held
+			void evict(u64 max_size)
+			{
+				while (m_total_size > max_size && !m_lru.empty())
+				{
+					const u64 key = m_lru.back();
+					const auto victim = m_entries.find(key);
+
+					fs::remove_file(get_path(key));
+					m_total_size -= victim->second.size;
+					m_entries.erase(victim);
+					m_lru.pop_back();
+					m_evictions++;
+
+					if (const auto found = m_prefetched.find(key); found != m_prefetched.end())
+					{
+						m_prefetched_bytes -= found->second.size();
+						m_prefetched.erase(found);
+					}
+				}
+			}
+
+			void prefetch(u64 key)
+			{
+				std::string path;
+				{
+					std::lock_guard lock(m_mutex);
+					m_prefetch_requests.erase(key);
+
+					const auto found = m_entries.find(key);
+
+					if (found == m_entries.end() || m_prefetched.count(key) || m_prefetched_bytes + found->second.size > max_prefetched_bytes)
+					{
+						return;
+					}
+
+					path = get_path(key);
+				}
+
+				fs::file file(path);
+
+				if (!file)
+				{
+					return;
+				}
+
+				std::vector<u8> data = file.to_vector<u8>();
+
+				std::lock_guard lock(m_mutex);
+
+				if (m_entries.count(key) && m_prefetched_bytes + data.size() <= max_prefetched_bytes)
+				{
+					m_prefetched_bytes += data.size();
+					m_prefetched.emplace(key, std::move(data));
+				}
+			}
+
+			// Reads the most recently used entries ahead, a new session is likely to start with the same assets
+			void prefetch_recent()
+			{
+				std::vector<u64> keys;
+				{
+					std::lock_guard lock(m_mutex);
+
+					u64 size = 0;
+
+					for (const u64 key : m_lru)
+					{
+						size += m_entries[key].size;
+
+						if (size > max_prefetched_bytes / 2)
+						{
+							break;
+						}
+
+						keys.push_back(key);
+					}
+				}
+
+				for (const u64 key : keys)
+				{
+					if (thread_ctrl::state() == thread_state::aborting)
+					{
+						break;
+					}
+
+					prefetch(key);
+				}
+			}
+
+			void process(cache_job_t& job)
+			{
+				const std::string path = get_path(job.key);
+
+				if (job.type == job_type::touch)
+				{
+					const s64 now = std::time(nullptr);
+					fs::utime(path, now, now);
+					return;
+				}
+
+				if (job.type == job_type::prefetch)
+				{
+					prefetch(job.key);
+					return;
+				}
+
+				const u64 size = sizeof(file_header_t) + job.payload.size();
+				bool written = false;
+
+				if (fs::pending_file file(path); file.file)
+				{
+					file.file.write(job.header);
+					file.file.write(job.payload.data(), job.payload.size());
+					written = file.commit();
+				}
+
+				m_queued_bytes -= job.payload.size();
+
+				std::lock_guard lock(m_mutex);
+				m_pending.erase(job.key);
+
+				if (!written)
+				{
+					rsx_log.warning("Texture disk cache: failed to write '%s' (%s)", path, fs::g_tls_error);
+					return;
+				}
+
+				if (auto [found, inserted] = m_entries.try_emplace(job.key, cache_entry_t{ size }); inserted)
+				{
+					m_lru.push_front(job.key);
+					found->second.lru = m_lru.begin();
+					m_total_size += size;
+				}
+
+				m_stores++;
+				evict(g_cfg.video.texture_disk_cache_size * u64{0x100000});
+			}
+
+			void operator()()
+			{
+				if (!g_cfg.video.texture_disk_cache || !initialize())
+				{
+					return;
+				}
+
+				prefetch_recent();
+
+				while (thread_ctrl::state() != thread_state::aborting)
+				{
+					for (auto&& job : m_queue.pop_all())
+					{
+						process(job);
+					}
+
+					thread_ctrl::wait_on(m_queue);
+				}
+			}
+		};
+
+		cache_thread* get_cache()
+		{
+			if (!g_cfg.video.texture_disk_cache)
+			{
+				return nullptr;
+			}
+
+			return g_fxo->try_get<named_thread<cache_thread>>();
+		}
+
+		bool is_expensive_transform(int format, bool is_swizzled, const texture_uploader_capabilities& caps)
+		{
+			switch (format)
+			{
+			case CELL_GCM_TEXTURE_COMPRESSED_DXT1:
+			case CELL_GCM_TEXTURE_COMPRESSED_DXT23:
+			case CELL_GCM_TEXTURE_COMPRESSED_DXT45:
+				return !caps.supports_dxt;
+			default:
+				return is_swizzled && !caps.supports_hw_deswizzle;
+			}
+		}
+	}
+
+	u64 get_key(const subresource_layout& src_layout, int format, bool is_swizzled, const texture_uploader_capabilities& caps)
+	{
+		if (!g_cfg.video.texture_disk_cache || !is_expensive_transform(format, is_swizzled, caps))
+		{
+			return 0;
+		}
+
+		const auto [src_ptr, src_size] = src_layout.data.raw();
+		if (!src_ptr || src_size < min_payload_size)
+		{
+			return 0;
+		}
+
+		key_desc_t desc;
+		std::memset(&desc, 0, sizeof(desc));
+		desc.format = format;
+		desc.width_in_texel = src_layout.width_in_texel;
+		desc.height_in_texel = src_layout.height_in_texel;
+		desc.width_in_block = src_layout.width_in_block;
+		desc.height_in_block = src_layout.height_in_block;
+		desc.depth = src_layout.depth;
+		desc.border = src_layout.border;
+		desc.is_swizzled = is_swizzled;
+		desc.pitch_in_block = src_layout.pitch_in_block;
+		desc.alignment = static_cast<u32>(caps.alignment);
+		desc.supports_byteswap = caps.supports_byteswap;
+		desc.supports_hw_deswizzle = caps.supports_hw_deswizzle;
+		desc.supports_dxt = caps.supports_dxt;
+		desc.use_bgra = g_cfg.video.bgra_format.get();
+		desc.version = cache_version;
+
+		const u64 key = XXH3_64bits_withSeed(src_ptr, src_size, rpcs3::hash_struct(desc));
+
+		// 0 is reserved for "not cacheable"
+		return key ? key : 1;
+	}
+
+	bool load(u64 key, const io_buffer& dst_buffer, texture_memory_info& result)
+	{
+		auto cache = get_cache();
+		if (!cache || !cache->m_ready)
+		{
+			return false;
+		}
+
+		std::vector<u8> data;
+		{
+			std::lock_guard lock(cache->m_mutex);
+
+			const auto found = cache->m_entries.find(key);
+			const auto prefetched = cache->m_prefetched.find(key);
+
+			if (found == cache->m_entries.end())
+			{
+				cache->m_misses++;
+				return false;
+			}
+
+			if (prefetched == cache->m_prefetched.end())
+			{
+				// Don't block the RSX thread on the disk, have it read for the next upload of the same data
+				if (cache->m_prefetch_requests.insert(key).second)
+				{
+					cache->m_queue.push(cache_job_t{ job_type::prefetch, key });
+				}
+
+				cache->m_misses++;
+				return false;
+			}
+
+			data = std::move(prefetched->second);
+			cache->m_prefetched.erase(prefetched);
+			cache->m_prefetched_bytes -= data.size();
+			cache->m_lru.splice(cache->m_lru.begin(), cache->m_lru, found->second.lru);
+		}
+
+		file_header_t header{};
+
+		if (data.size() >= sizeof(header))
+		{
+			std::memcpy(&header, data.data(), sizeof(header));
+		}
+
+		if (header.magic != cache_magic || header.version != cache_version || header.key != key || data.size() != sizeof(header) + header.payload_size)
+		{
+			cache->m_misses++;
+			return false;
+		}
+
+		// The allocator is only invoked here, a miss does not consume upload heap space
+		void* dst = dst_buffer.data();
+		if (header.payload_size != dst_buffer.size())
+		{
+			cache->m_misses++;
+			return false;
+		}
+
+		std::memcpy(dst, data.data() + sizeof(header), header.payload_size);
+
+		result.element_size = header.element_size;
+		result.block_length = header.block_length;
+		result.require_mth = header.require_mth;
+
+		cache->m_hits++;
+
+		// Refresh the on-disk timestamp so that recency survives restarts
+		cache->m_queue.push(cache_job_t{ job_type::touch, key });
+		return true;
+	}
+
+	void store(u64 key, const io_buffer& src_buffer, const texture_memory_info& info)
+	{
+		auto cache = get_cache();
+		if (!cache || !info.deferred_cmds.empty() || (info.require_mth & texture_memory_info_require_mth::upload))
+		{
+			return;
+		}
+
+		const auto [src_ptr, src_size] = src_buffer.raw();
+		if (!src_ptr || !src_size || (cache->m_queued_bytes + src_size) > max_queued_bytes)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard lock(cache->m_mutex);
+
+			if (!cache->m_ready || cache->m_entries.count(key) || !cache->m_pending.insert(key).second)
+			{
+				return;
+			}
+		}
+
+		cache_job_t job{};
+		job.type = job_type::write;
+		job.key = key;
+		job.header = { cache_magic, cache_version, key, static_cast<u32>(src_size), info.element_size, info.block_length, info.require_mth };
+		job.payload.resize(src_size);
+		std::memcpy(job.payload.data(), src_ptr, src_size);
+
+		cache->m_queued_bytes += src_size;
+		cache->m_queue.push(std::move(job));
+	}
+
+	stats_t get_stats()
+	{
+		stats_t result{};
+
+		if (auto cache = get_cache())
+		{
+			result.hits = cache->m_hits;
+			result.misses = cache->m_misses;
+			result.stores = cache->m_stores;
+			result.evictions = cache->m_evictions;
+
+			reader_lock lock(cache->m_mutex);
+			result.entry_count = cache->m_entries.size();
+			result.bytes_on_disk = cache->m_total_size;
+		}
+
+		return result;
+	}
+
+	std::string format_stats()
+	{
+		const auto stats = get_stats();
+		return fmt::format("%llu hits, %llu misses, %llu entries (%lluM), %llu evicted",
+			stats.hits, stats.misses, stats.entry_count, stats.bytes_on_disk / 0x100000, stats.evictions);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "TextureUtils.h"
+
+#include <string>
+
+// Persistent cache for texture payloads that needed an expensive CPU transform before upload (DXT decode, deswizzle).
+// Entries are keyed on a hash of the guest data together with every parameter that affects the output, so a hit can be
+// copied straight into the upload buffer. Disk I/O happens on a background thread which reads entries ahead and writes new
+// ones, eviction is LRU with a size cap.
+namespace rsx::texture_disk_cache
+{
+	struct stats_t
+	{
+		u64 hits = 0;
+		u64 misses = 0;
+		u64 stores = 0;
+		u64 evictions = 0;
+		u64 entry_count = 0;
+		u64 bytes_on_disk = 0;
+	};
+
+	// Returns 0 if the subresource is not worth caching
+	u64 get_key(const subresource_layout& src_layout, int format, bool is_swizzled, const texture_uploader_capabilities& caps);
+
+	// Fills dst_buffer from the cache. Returns false on a miss, the caller then has to produce the data itself.
+	bool load(u64 key, const io_buffer& dst_buffer, texture_memory_info& result);
+
+	// Queues the decoded payload for writing. The data is copied, dst_buffer can be reused immediately.
+	void store(u64 key, const io_buffer& src_buffer, const texture_memory_info& info);
+
+	stats_t get_stats();
+	std::string format_stats();
+}
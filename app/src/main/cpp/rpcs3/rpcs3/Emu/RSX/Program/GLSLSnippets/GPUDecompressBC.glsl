@@ -0,0 +1,177 @@
+R"(
+#version 450
+
+#define SSBO_LOCATION(x) (x + %loc)
+#define BC_VERSION %bc
+#define USE_BGRA %bgra
+
+layout(local_size_x = %ws, local_size_y = 1, local_size_z = 1) in;
+
+layout(%set, binding=SSBO_LOCATION(0), std430) buffer ssbo0{ uint data_in[]; };
+layout(%set, binding=SSBO_LOCATION(1), std430) buffer ssbo1{ uint data_out[]; };
+layout(%push_block) uniform parameters
+{
+	uint width_in_block;
+	uint height_in_block;
+	uint image_depth;
+	uint width_in_texel;
+	uint height_in_texel;
+	uint dst_pitch_in_texel;
+};
+
+// Integer math mirrors bcdec so that the output is bit-identical to the CPU decoder
+uint pack_color(const in uint r, const in uint g, const in uint b, const in uint a)
+{
+#if USE_BGRA
+	return (a << 24) | (r << 16) | (g << 8) | b;
+#else
+	return (a << 24) | (b << 16) | (g << 8) | r;
+#endif
+}
+
+uint decode_color(const in uint c0, const in uint c1, const in uint index, const in bool opaque_only)
+{
+	const uint r0 = (c0 >> 11) & 0x1F;
+	const uint g0 = (c0 >> 5) & 0x3F;
+	const uint b0 = c0 & 0x1F;
+	const uint r1 = (c1 >> 11) & 0x1F;
+	const uint g1 = (c1 >> 5) & 0x3F;
+	const uint b1 = c1 & 0x1F;
+
+	switch (index)
+	{
+	case 0:
+		return pack_color((r0 * 527 + 23) >> 6, (g0 * 259 + 33) >> 6, (b0 * 527 + 23) >> 6, 0xFF);
+	case 1:
+		return pack_color((r1 * 527 + 23) >> 6, (g1 * 259 + 33) >> 6, (b1 * 527 + 23) >> 6, 0xFF);
+	}
+
+	if (c0 > c1 || opaque_only)
+	{
+		if (index == 2)
+		{
+			return pack_color(((2 * r0 + r1) * 351 + 61) >> 7, ((2 * g0 + g1) * 2763 + 1039) >> 11, ((2 * b0 + b1) * 351 + 61) >> 7, 0xFF);
+		}
+
+		return pack_color(((r0 + r1 * 2) * 351 + 61) >> 7, ((g0 + g1 * 2) * 2763 + 1039) >> 11, ((b0 + b1 * 2) * 351 + 61) >> 7, 0xFF);
+	}
+
+	if (index == 2)
+	{
+		return pack_color(((r0 + r1) * 1053 + 125) >> 8, ((g0 + g1) * 4145 + 1019) >> 11, ((b0 + b1) * 1053 + 125) >> 8, 0xFF);
+	}
+
+	return 0;
+}
+
+uint decode_sharp_alpha(const in uint word0, const in uint word1, const in uint texel)
+{
+	const uint nibble = (texel < 8) ? (word0 >> (texel * 4)) : (word1 >> ((texel - 8) * 4));
+	return (nibble & 0xF) * 17;
+}
+
+uint decode_smooth_alpha(const in uint word0, const in uint word1, const in uint texel)
+{
+	const uint a0 = word0 & 0xFF;
+	const uint a1 = (word0 >> 8) & 0xFF;
+
+	// 48 bits of 3-bit indices start at bit 16 of the block
+	const uint bit = 16 + texel * 3;
+	uint index;
+
+	if (bit >= 32)
+	{
+		index = (word1 >> (bit - 32)) & 7;
+	}
+	else if (bit <= 29)
+	{
+		index = (word0 >> bit) & 7;
+	}
+	else
+	{
+		index = ((word0 >> bit) | (word1 << (32 - bit))) & 7;
+	}
+
+	if (index < 2)
+	{
+		return (index == 0) ? a0 : a1;
+	}
+
+	if (a0 > a1)
+	{
+		return ((8 - index) * a0 + (index - 1) * a1) / 7;
+	}
+
+	if (index < 6)
+	{
+		return ((6 - index) * a0 + (index - 1) * a1) / 5;
+	}
+
+	return (index == 6) ? 0 : 0xFF;
+}
+
+void main()
+{
+	const uint invocations_x = (gl_NumWorkGroups.x * gl_WorkGroupSize.x);
+	const uint block_id = (gl_GlobalInvocationID.y * invocations_x) + gl_GlobalInvocationID.x;
+	const uint slice_length = width_in_block * height_in_block;
+
+	if (block_id >= (slice_length * image_depth))
+	{
+		return;
+	}
+
+	const uint z = block_id / slice_length;
+	const uint slice_offset = block_id % slice_length;
+	const uint block_x = (slice_offset % width_in_block) * 4;
+	const uint block_y = (slice_offset / width_in_block) * 4;
+
+#if BC_VERSION == 1
+	const uint src_id = block_id * 2;
+	const uint color_word = data_in[src_id];
+	const uint index_word = data_in[src_id + 1];
+	const bool opaque_only = false;
+#else
+	const uint src_id = block_id * 4;
+	const uint alpha_word0 = data_in[src_id];
+	const uint alpha_word1 = data_in[src_id + 1];
+	const uint color_word = data_in[src_id + 2];
+	const uint index_word = data_in[src_id + 3];
+	const bool opaque_only = true;
+#endif
+
+	const uint c0 = color_word & 0xFFFF;
+	const uint c1 = color_word >> 16;
+
+	for (uint y = 0; y < 4; ++y)
+	{
+		const uint row = block_y + y;
+		if (row >= height_in_texel)
+		{
+			break;
+		}
+
+		const uint dst_row = ((z * height_in_texel) + row) * dst_pitch_in_texel;
+
+		for (uint x = 0; x < 4; ++x)
+		{
+			const uint col = block_x + x;
+			if (col >= width_in_texel)
+			{
+				break;
+			}
+
+			const uint texel = (y * 4) + x;
+			uint value = decode_color(c0, c1, (index_word >> (texel * 2)) & 3, opaque_only);
+
+#if BC_VERSION == 2
+			value = (value & 0x00FFFFFF) | (decode_sharp_alpha(alpha_word0, alpha_word1, texel) << 24);
+#elif BC_VERSION == 3
+			value = (value & 0x00FFFFFF) | (decode_smooth_alpha(alpha_word0, alpha_word1, texel) << 24);
+#endif
+
+			data_out[dst_row + col] = value;
+		}
+	}
+}
+)"
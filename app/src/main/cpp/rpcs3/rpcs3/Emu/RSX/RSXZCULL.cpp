@@ -374,6 +374,22 @@ namespace rsx
 				// No other queries in the chain, write result
 				const auto value = (writer->type == CELL_GCM_ZPASS_PIXEL_CNT) ? m_statistics_map[writer->counter_tag].result : result;
 				write(writer, ptimer->timestamp(), value);
+
+				if (writer->predicted && (writer->predicted_value != 0) != (value != 0))
+				{
+					m_prediction_stats.mispredicted_reports++;
+				}
+
+				if (g_cfg.video.predictive_zcull_reports)
+				{
+					if (m_report_history.size() >= max_stat_registers) [[unlikely]]
+					{
+						// Report areas are usually small and reused, this should not happen normally
+						m_report_history.clear();
+					}
+
+					m_report_history[writer->sink] = value;
+				}
 			}
 
 			if (writer->query && writer->query->sync_tag == ptimer->cond_render_ctrl.eval_sync_tag)
@@ -416,6 +432,14 @@ namespace rsx
 				return;
 			}
 
+			if (g_cfg.video.predictive_zcull_reports)
+			{
+				// Retire what is available, then answer the rest with predictions instead of waiting on the GPU
+				update(ptimer, 0, true);
+				predict_pending_reports(ptimer);
+				return;
+			}
+
 			// Quick reverse scan to push commands ahead of time
 			for (auto It = m_pending_writes.rbegin(); It != m_pending_writes.rend(); ++It)
 			{
@@ -508,6 +532,52 @@ namespace rsx
 			ptimer->async_tasks_pending -= processed;
 		}
 
+		void ZCULL_control::predict_pending_reports(::rsx::thread* ptimer)
+		{
+			u32 predicted = 0;
+			const u64 timestamp = ptimer->timestamp();
+
+			for (auto& writer : m_pending_writes)
+			{
+				if (!writer.sink)
+				{
+					break;
+				}
+
+				if (writer.predicted || writer.forwarder)
+				{
+					// Already answered, or the value is written by the last writer in the chain
+					continue;
+				}
+
+				u32 value = m_statistics_map[writer.counter_tag].result;
+				if (!value)
+				{
+					// Use the last result seen at this address. If there is none, assume visible.
+					// A false 'visible' only costs some extra drawing, a false 'occluded' makes geometry disappear.
+					const auto found = m_report_history.find(writer.sink);
+					value = (found != m_report_history.end()) ? found->second : 1u;
+				}
+
+				write(writer.sink, timestamp, writer.type, value);
+
+				for (auto& addr : writer.sink_alias)
+				{
+					write(addr, timestamp, writer.type, value);
+				}
+
+				writer.predicted = true;
+				writer.predicted_value = value;
+				predicted++;
+			}
+
+			if (predicted)
+			{
+				m_prediction_stats.avoided_syncs++;
+				m_prediction_stats.predicted_reports += predicted;
+			}
+		}
+
 		void ZCULL_control::update(::rsx::thread* ptimer, u32 sync_address, bool hint)
 		{
 			if (m_pending_writes.empty())
@@ -52,6 +52,9 @@ namespace rsx
 
 			vm::addr_t sink;                      // Memory location of the report
 			std::vector<vm::addr_t> sink_alias;   // Aliased memory addresses
+
+			bool predicted = false;               // A predicted value was written to the sink ahead of the real result
+			u32 predicted_value = 0;
 		};
 
 		struct query_search_result
@@ -67,6 +70,13 @@ namespace rsx
 			u32 flags;
 		};
 
+		struct prediction_stats_t
+		{
+			u64 avoided_syncs = 0;        // Hard syncs answered with predicted values instead of waiting on the GPU
+			u64 predicted_reports = 0;    // Reports written ahead of their real result
+			u64 mispredicted_reports = 0; // Predictions whose visibility did not match the real result
+		};
+
 		struct sync_hint_payload_t
 		{
 			occlusion_query_info* query;
@@ -132,6 +142,10 @@ namespace rsx
 			std::vector<queued_report_write> m_pending_writes{};
 			std::array<query_stat_counter, max_stat_registers> m_statistics_map{};
 
+			// Last retired result per report address. Used to predict results that are still in flight.
+			std::unordered_map<u32, u32> m_report_history{};
+			prediction_stats_t m_prediction_stats{};
+
 			// Enables/disables the ZCULL unit
 			void set_active(class ::rsx::thread* ptimer, bool state, bool flush_queue);
 
@@ -151,6 +165,9 @@ namespace rsx
 			// Retire operation
 			void retire(class ::rsx::thread* ptimer, queued_report_write* writer, u32 result);
 
+			// Writes predicted values for claimed reports still in flight. Real values overwrite them on retire.
+			void predict_pending_reports(class ::rsx::thread* ptimer);
+
 		public:
 
 			ZCULL_control();
@@ -199,6 +216,9 @@ namespace rsx
 			// Optimization check
 			bool is_query_result_urgent(u32 address) const { return m_pages_accessed[rsx::classify_location(address)]; }
 
+			// Predictive readback statistics
+			const prediction_stats_t& get_prediction_stats() const { return m_prediction_stats; }
+
 			// Backend methods (optional, will return everything as always visible by default)
 			virtual void begin_occlusion_query(occlusion_query_info* /*query*/) {}
 			virtual void end_occlusion_query(occlusion_query_info* /*query*/) {}
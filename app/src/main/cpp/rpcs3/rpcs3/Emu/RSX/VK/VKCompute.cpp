@@ -170,7 +170,7 @@ namespace vk
 		// CmdDispatch is outside renderpass scope only
 		if (vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::compute);
 		}
 		load_program(cmd);
 		_vkCmdDispatch(cmd, invocations_x, invocations_y, invocations_z);
@@ -4,6 +4,7 @@
 #include "vkutils/buffer_object.h"
 
 #include "Emu/IdManager.h"
+#include "Emu/system_config.h"
 
 #include "Utilities/StrUtil.h"
 #include "util/asm.hpp"
@@ -401,17 +402,104 @@ namespace vk
 		}
 	};
 
-    struct cs_bc_decode_base: compute_task
+	// Expands DXT1/3/5 (BC1/2/3) blocks to 32-bit texels for devices without native BC sampling
+	struct cs_bc_decode_base : compute_task
 	{
-        virtual void run(const vk::command_buffer& cmd, const vk::buffer* dst, u32 out_offset, const vk::buffer* src, u32 in_offset, u32 data_length, u32 width, u32 height, u32 depth, u32 mipmaps) = 0;
+		virtual void run(const vk::command_buffer& cmd, const vk::buffer* dst, u32 out_offset, const vk::buffer* src, u32 in_offset,
+			u32 width_in_texel, u32 height_in_texel, u32 depth, u32 dst_pitch_in_texel) = 0;
 	};
 
-#if 0
-    template <int bc_ver>
-    struct cs_bc_decode_task: cs_bc_decode_base{
+	template <int bc_ver>
+	struct cs_bc_decode_task : cs_bc_decode_base
+	{
+		union params_t
+		{
+			u32 data[6];
+
+			struct
+			{
+				u32 width_in_block;
+				u32 height_in_block;
+				u32 depth;
+				u32 width_in_texel;
+				u32 height_in_texel;
+				u32 dst_pitch_in_texel;
+			};
+		}
+		params;
+
+		const vk::buffer* src_buffer = nullptr;
+		const vk::buffer* dst_buffer = nullptr;
+		u32 in_offset = 0;
+		u32 out_offset = 0;
+		u32 in_block_length = 0;
+		u32 out_block_length = 0;
+
+		cs_bc_decode_task()
+		{
+			static_assert(bc_ver >= 1 && bc_ver <= 3, "Unsupported BC version");
+
+			ssbo_count = 2;
+			use_push_constants = true;
+			push_constants_size = sizeof(params_t);
+
+			create();
+
+			m_src =
+			#include "../Program/GLSLSnippets/GPUDecompressBC.glsl"
+			;
+
+			const std::pair<std::string_view, std::string> syntax_replace[] =
+			{
+				{ "%loc", "0" },
+				{ "%set", "set = 0" },
+				{ "%push_block", "push_constant" },
+				{ "%ws", std::to_string(optimal_group_size) },
+				{ "%bc", std::to_string(bc_ver) },
+				{ "%bgra", g_cfg.video.bgra_format ? "1" : "0" }
+			};
+
+			m_src = fmt::replace_all(m_src, syntax_replace);
+		}
+
+		void bind_resources() override
+		{
+			m_program->bind_buffer({ src_buffer->value, in_offset, in_block_length }, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_descriptor_set);
+			m_program->bind_buffer({ dst_buffer->value, out_offset, out_block_length }, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_descriptor_set);
+		}
+
+		void set_parameters(const vk::command_buffer& cmd)
+		{
+			_vkCmdPushConstants(cmd, m_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, push_constants_size, params.data);
+		}
+
+		void run(const vk::command_buffer& cmd, const vk::buffer* dst, u32 out_offset, const vk::buffer* src, u32 in_offset,
+			u32 width_in_texel, u32 height_in_texel, u32 depth, u32 dst_pitch_in_texel) override
+		{
+			constexpr u32 block_size = (bc_ver == 1) ? 8 : 16;
+
+			dst_buffer = dst;
+			src_buffer = src;
+
+			params.width_in_block = utils::aligned_div(width_in_texel, 4u);
+			params.height_in_block = utils::aligned_div(height_in_texel, 4u);
+			params.depth = depth;
+			params.width_in_texel = width_in_texel;
+			params.height_in_texel = height_in_texel;
+			params.dst_pitch_in_texel = dst_pitch_in_texel;
+
+			const u32 block_count = params.width_in_block * params.height_in_block * depth;
+
+			this->in_offset = in_offset;
+			this->out_offset = out_offset;
+			this->in_block_length = block_count * block_size;
+			this->out_block_length = dst_pitch_in_texel * height_in_texel * depth * 4;
+			set_parameters(cmd);
+
+			compute_task::run(cmd, utils::aligned_div(block_count, optimal_group_size));
+		}
+	};
 
-    };
-#endif
 	// Reverse morton-order block arrangement
 	struct cs_deswizzle_base : compute_task
 	{
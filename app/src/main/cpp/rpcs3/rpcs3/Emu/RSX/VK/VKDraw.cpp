@@ -101,18 +101,26 @@ namespace vk
 	}
 }
 
-void VKGSRender::begin_render_pass()
+void VKGSRender::begin_render_pass(u32 load_discard_mask)
 {
+	VkRenderPass load_discard_pass = VK_NULL_HANDLE;
+	if (load_discard_mask && !vk::is_renderpass_open(*m_current_command_buffer))
+	{
+		// The caller is going to overwrite these attachments in full, don't pull their old contents in
+		load_discard_pass = vk::get_renderpass(*m_device, vk::get_renderpass_discard_key(m_current_renderpass_key, load_discard_mask));
+	}
+
 	vk::begin_renderpass(
 		*m_current_command_buffer,
 		get_render_pass(),
 		m_draw_fbo->value,
-		{ positionu{0u, 0u}, sizeu{m_draw_fbo->width(), m_draw_fbo->height()} });
+		{ positionu{0u, 0u}, sizeu{m_draw_fbo->width(), m_draw_fbo->height()} },
+		load_discard_pass);
 }
 
-void VKGSRender::close_render_pass()
+void VKGSRender::close_render_pass(vk::renderpass_break_reason reason)
 {
-	vk::end_renderpass(*m_current_command_buffer);
+	vk::end_renderpass(*m_current_command_buffer, reason);
 }
 
 VkRenderPass VKGSRender::get_render_pass()
@@ -817,7 +825,7 @@ void VKGSRender::emit_geometry(u32 sub_index)
 		if (vk::use_strict_query_scopes() &&
 			vk::is_renderpass_open(*m_current_command_buffer))
 		{
-			vk::end_renderpass(*m_current_command_buffer);
+			vk::end_renderpass(*m_current_command_buffer, vk::renderpass_break_reason::query_scope);
 			emergency_query_cleanup(m_current_command_buffer);
 		}
 
@@ -925,7 +933,7 @@ void VKGSRender::emit_geometry(u32 sub_index)
 		if (pass)
 		{
 			// Subpass mismatch, end it before proceeding
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::pass_mismatch);
 		}
 
 		// Starting a new renderpass should clobber dynamic state
@@ -14,6 +14,8 @@
 #include "vkutils/buffer_object.h"
 #include "vkutils/scratch.h"
 
+#include "Emu/cache_utils.hpp"
+#include "Emu/memory_governor.hpp"
 #include "Emu/RSX/rsx_methods.h"
 #include "Emu/RSX/Host/MM.h"
 #include "Emu/RSX/Host/RSXDMAWriter.h"
@@ -542,6 +544,13 @@ VKGSRender::VKGSRender(utils::serial* ar) noexcept : GSRender(ar)
 	semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
 	// VRAM allocation
+	if (const std::string cache_path = rpcs3::cache::get_ppu_cache(); !cache_path.empty())
+	{
+		// Start with the heap sizes this title ended up needing last time
+		m_heap_size_hints_path = cache_path + "vk_heap_sizes.txt";
+		vk::load_heap_size_hints(m_heap_size_hints_path);
+	}
+
 	m_attrib_ring_info.create(VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT, VK_ATTRIB_RING_BUFFER_SIZE_M * 0x100000, "attrib buffer", 0x400000, VK_TRUE);
 	m_fragment_env_ring_info.create(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_UBO_RING_BUFFER_SIZE_M * 0x100000, "fragment env buffer");
 	m_vertex_env_ring_info.create(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_UBO_RING_BUFFER_SIZE_M * 0x100000, "vertex env buffer");
@@ -562,6 +571,37 @@ VKGSRender::VKGSRender(utils::serial* ar) noexcept : GSRender(ar)
 		m_fragment_instructions_buffer.create(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 64 * 0x100000, "fragment instructions buffer", 2048);
 	}
 
+	// Export our pools to the memory governor. These are report-only, trimming is handled by on_vram_exhausted
+	// which receives the governor's view of host memory pressure through vk::vmm_check_memory_usage.
+	{
+		using namespace rpcs3::memory_governor;
+
+		m_memory_governor_pools.push_back(register_pool({ "Texture cache", pool_priority::texture_cache,
+			[]() { return vk::vmm_get_application_pool_usage(VMM_ALLOCATION_POOL_TEXTURE_CACHE); } }));
+
+		m_memory_governor_pools.push_back(register_pool({ "Surface cache", pool_priority::surface_cache,
+			[]() { return vk::vmm_get_application_pool_usage(VMM_ALLOCATION_POOL_SURFACE_CACHE); } }));
+
+		m_memory_governor_pools.push_back(register_pool({ "Ring heaps", pool_priority::ring_heap, [this]()
+		{
+			u64 result = 0;
+			for (const vk::data_heap* heap : {
+				&m_attrib_ring_info, &m_fragment_env_ring_info, &m_vertex_env_ring_info, &m_fragment_texture_params_ring_info,
+				&m_vertex_layout_ring_info, &m_fragment_constants_ring_info, &m_transform_constants_ring_info, &m_index_buffer_ring_info,
+				&m_texture_upload_buffer_ring_info, &m_raster_env_ring_info, &m_instancing_buffer_ring_info,
+				&m_fragment_instructions_buffer, &m_vertex_instructions_buffer })
+			{
+				result += heap->heap ? heap->size() : 0;
+			}
+			return result;
+		} }));
+
+		m_memory_governor_pools.push_back(register_pool({ "Scratch and system", pool_priority::ring_heap, []()
+		{
+			return vk::vmm_get_application_pool_usage(VMM_ALLOCATION_POOL_SCRATCH) + vk::vmm_get_application_pool_usage(VMM_ALLOCATION_POOL_SWAPCHAIN);
+		} }));
+	}
+
 	// Initialize optional allocation information with placeholders
 	m_vertex_env_buffer_info = { m_vertex_env_ring_info.heap->value, 0, 16 };
 	m_vertex_constants_buffer_info = { m_transform_constants_ring_info.heap->value, 0, 16 };
@@ -833,6 +873,21 @@ VKGSRender::~VKGSRender()
 	// Upscaler (references some global resources)
 	m_upscaler.reset();
 
+	for (const auto pool : m_memory_governor_pools)
+	{
+		rpcs3::memory_governor::unregister_pool(pool);
+	}
+
+	if (!m_heap_size_hints_path.empty())
+	{
+		vk::save_heap_size_hints(m_heap_size_hints_path,
+		{
+			&m_attrib_ring_info, &m_fragment_env_ring_info, &m_vertex_env_ring_info, &m_fragment_texture_params_ring_info,
+			&m_vertex_layout_ring_info, &m_fragment_constants_ring_info, &m_transform_constants_ring_info, &m_index_buffer_ring_info,
+			&m_texture_upload_buffer_ring_info, &m_raster_env_ring_info, &m_instancing_buffer_ring_info
+		});
+	}
+
 	// Heaps
 	m_attrib_ring_info.destroy();
 	m_fragment_env_ring_info.destroy();
@@ -1276,6 +1331,41 @@ void VKGSRender::check_heap_status(u32 flags)
 	}
 }
 
+void VKGSRender::rebalance_ring_heaps()
+{
+	bool heaps_replaced = false;
+
+	for (auto heap : {
+		&m_attrib_ring_info, &m_fragment_env_ring_info, &m_vertex_env_ring_info, &m_fragment_texture_params_ring_info,
+		&m_vertex_layout_ring_info, &m_fragment_constants_ring_info, &m_transform_constants_ring_info, &m_index_buffer_ring_info,
+		&m_texture_upload_buffer_ring_info, &m_raster_env_ring_info, &m_instancing_buffer_ring_info })
+	{
+		heaps_replaced |= heap->rebalance();
+	}
+
+	if (!heaps_replaced)
+	{
+		return;
+	}
+
+	// Heap pointers recorded by in-flight frames refer to the old buffers and must not be applied
+	m_last_heap_sync_time = rsx::get_shared_tag();
+
+	// Persistent texel views may point into a replaced buffer. The heap_changed interrupt cannot be relied upon to catch this
+	// as it is shared by all heaps and cleared by whichever check runs first.
+	for (auto view : { &m_persistent_attribute_storage, &m_volatile_attribute_storage, &m_vertex_layout_storage })
+	{
+		if (*view)
+		{
+			m_current_frame->buffer_views_to_clean.push_back(std::move(*view));
+		}
+	}
+
+	// Cached descriptor info may reference the old buffers. Force everything to be uploaded again.
+	m_graphics_state |= (rsx::vertex_state_dirty | rsx::fragment_state_dirty | rsx::transform_constants_dirty |
+		rsx::fragment_constants_dirty | rsx::fragment_texture_state_dirty | rsx::polygon_stipple_pattern_dirty);
+}
+
 void VKGSRender::check_present_status()
 {
 	while (!m_queued_frames.empty())
@@ -1639,7 +1729,24 @@ void VKGSRender::clear_surface(u32 mask)
 
 	if (!clear_descriptors.empty())
 	{
-		begin_render_pass();
+		u32 load_discard_mask = 0;
+		if (full_frame)
+		{
+			// Attachments cleared in full don't need their previous contents loaded when the pass opens
+			for (const auto& clear : clear_descriptors)
+			{
+				if (clear.aspectMask == VK_IMAGE_ASPECT_COLOR_BIT)
+				{
+					load_discard_mask |= (1u << clear.colorAttachment);
+				}
+				else if (clear.aspectMask == std::get<1>(m_rtts.m_bound_depth_stencil)->aspect())
+				{
+					load_discard_mask |= (1u << ::size32(m_draw_buffers));
+				}
+			}
+		}
+
+		begin_render_pass(load_discard_mask);
 		_vkCmdClearAttachments(*m_current_command_buffer, ::size32(clear_descriptors), clear_descriptors.data(), 1, &region);
 	}
 }
@@ -1729,7 +1836,7 @@ bool VKGSRender::release_GCM_label(u32 address, u32 args)
 	{
 		if (vk::is_renderpass_open(*m_current_command_buffer))
 		{
-			vk::end_renderpass(*m_current_command_buffer);
+			vk::end_renderpass(*m_current_command_buffer, vk::renderpass_break_reason::transfer);
 		}
 
 		_vkCmdUpdateBuffer(*m_current_command_buffer, mapping.second->value, mapping.first, 4, &write_data);
@@ -2532,7 +2639,7 @@ void VKGSRender::close_and_submit_command_buffer(vk::fence* pFence, VkSemaphore
 	// End any active renderpasses; the caller should handle reopening
 	if (vk::is_renderpass_open(*m_current_command_buffer))
 	{
-		close_render_pass();
+		close_render_pass(vk::renderpass_break_reason::submit);
 	}
 
 	// End open queries. Flags will be automatically reset by the submit routine
@@ -2900,7 +3007,7 @@ void VKGSRender::end_occlusion_query(rsx::reports::occlusion_query_info* query)
 		if (vk::use_strict_query_scopes() &&
 			vk::is_renderpass_open(*m_current_command_buffer))
 		{
-			vk::end_renderpass(*m_current_command_buffer);
+			vk::end_renderpass(*m_current_command_buffer, vk::renderpass_break_reason::query_scope);
 		}
 
 		// End query
@@ -17,6 +17,7 @@
 #include "VKFramebuffer.h"
 #include "VKShaderInterpreter.h"
 #include "VKQueryPool.h"
+#include "VKRenderPass.h"
 
 #include "Emu/RSX/GSRender.h"
 #include "Emu/RSX/Host/RSXDMAWriter.h"
@@ -150,6 +151,12 @@ private:
 	vk::data_heap m_fragment_instructions_buffer;
 	vk::data_heap m_vertex_instructions_buffer;
 
+	// Pools exported to the memory governor
+	std::vector<u32> m_memory_governor_pools;
+
+	// Per-title record of ring heap high-water marks
+	std::string m_heap_size_hints_path;
+
 	VkDescriptorBufferInfo m_vertex_env_buffer_info {};
 	VkDescriptorBufferInfo m_fragment_env_buffer_info {};
 	VkDescriptorBufferInfo m_vertex_layout_stream_info {};
@@ -189,6 +196,9 @@ private:
 	vk::draw_call_t m_current_draw {};
 	u64 m_current_renderpass_key = 0;
 	VkRenderPass m_cached_renderpass = VK_NULL_HANDLE;
+
+	// Renderpass statistics of the last completed frame
+	vk::renderpass_stats_t m_last_frame_renderpass_stats{};
 	std::vector<vk::image*> m_fbo_images;
 
 	//Vertex layout
@@ -226,13 +236,14 @@ private:
 
     vk::viewable_image* get_present_source(vk::present_surface_info* info, const rsx::avconf& avconfig);
 
-	void begin_render_pass();
-	void close_render_pass();
+	void begin_render_pass(u32 load_discard_mask = 0);
+	void close_render_pass(vk::renderpass_break_reason reason);
 	VkRenderPass get_render_pass();
 
 	void update_draw_state();
 
 	void check_heap_status(u32 flags = VK_HEAP_CHECK_ALL);
+	void rebalance_ring_heaps();
 	void check_present_status();
 
 	VkDescriptorSet allocate_descriptor_set();
@@ -6,6 +6,7 @@ VK_FUNC(vkDestroyDebugReportCallbackEXT);
 
 VK_FUNC(vkGetPhysicalDeviceFeatures2KHR);
 VK_FUNC(vkGetPhysicalDeviceProperties2KHR);
+VK_FUNC(vkGetPhysicalDeviceMemoryProperties2KHR);
 
 VK_FUNC(vkGetPhysicalDeviceSurfaceCapabilities2KHR);
 
@@ -3,6 +3,8 @@
 #include "vkutils/buffer_object.h"
 #include "Emu/RSX/Overlays/overlay_manager.h"
 #include "Emu/RSX/Overlays/overlay_debug_overlay.h"
+#include "Emu/RSX/Common/texture_disk_cache.h"
+#include "Emu/Cell/Modules/cellAudio.h"
 #include "Emu/Cell/Modules/cellVideoOut.h"
 
 #include "upscalers/bilinear_pass.hpp"
@@ -11,6 +13,8 @@
 #include "util/asm.hpp"
 #include "util/video_provider.h"
 
+#include "Emu/memory_governor.hpp"
+
 #include "meminfo.h"
 
 extern atomic_t<bool> g_user_asked_for_screenshot;
@@ -171,6 +175,13 @@ void VKGSRender::advance_queued_frames()
 	vk::remove_unused_framebuffers();
 
 	m_vertex_cache->purge();
+
+	// Resize ring heaps on the frame boundary
+	rebalance_ring_heaps();
+
+	m_last_frame_renderpass_stats = vk::get_renderpass_stats();
+	vk::reset_renderpass_stats();
+
 	m_current_frame->tag_frame_end(m_attrib_ring_info.get_current_put_pos_minus_one(),
 		m_vertex_env_ring_info.get_current_put_pos_minus_one(),
 		m_fragment_env_ring_info.get_current_put_pos_minus_one(),
@@ -883,6 +894,9 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 			const auto program_cache_ellision_rate = program_cache_lookups
 				? (program_cache_ellided * 100) / program_cache_lookups
 				: 0;
+			const auto& surface_pool_stats = m_rtts.m_pool_stats;
+			const auto& resolve_pool_stats = vk::surface_cache_utils::get_resolve_image_pool_stats();
+			const auto& zcull_stats = zcull_ctrl->get_prediction_stats();
 
 			rsx::overlays::set_debug_overlay_text(fmt::format(
 				"Internal Resolution:      %s\n"
@@ -900,7 +914,12 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 				"Flush requests: %13d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)\n"
 				"Texture uploads: %12u (%u from CPU - %02u%%, %u copies avoided)\n"
 				"Vertex cache hits: %10u/%u (%u%%)\n"
-				"Program cache lookup ellision: %u/%u (%u%%)",
+				"Program cache lookup ellision: %u/%u (%u%%)\n"
+				"Render passes: %s\n"
+				"Surface pool: %llu pooled, %llu fresh (%u%%), resolve targets %llu pooled, %llu fresh\n"
+				"ZCULL predictions: %llu syncs avoided, %llu reports predicted, %llu mispredicted\n"
+				"Texture disk cache: %s\n"
+				"Audio: %s",
 
 				info.stats.framebuffer_stats.to_string(!backend_config.supports_hw_msaa),
 				get_load(), info.stats.draw_calls, info.stats.submit_count, info.stats.setup_time, info.stats.vertex_upload_time,
@@ -909,7 +928,13 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 				num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate,
 				num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio, texture_copies_ellided,
 				vertex_cache_hit_count, info.stats.vertex_cache_request_count, vertex_cache_hit_ratio,
-				program_cache_ellided, program_cache_lookups, program_cache_ellision_rate)
+				program_cache_ellided, program_cache_lookups, program_cache_ellision_rate,
+				m_last_frame_renderpass_stats.to_string(),
+				surface_pool_stats.pooled_allocations, surface_pool_stats.fresh_allocations, surface_pool_stats.get_pooled_percentage(),
+				resolve_pool_stats.pooled_allocations, resolve_pool_stats.fresh_allocations,
+				zcull_stats.avoided_syncs, zcull_stats.predicted_reports, zcull_stats.mispredicted_reports,
+				g_cfg.video.texture_disk_cache ? rsx::texture_disk_cache::format_stats() : std::string("Disabled"),
+				audio::format_latency_stats())
 			);
 		}
         else if(g_cfg.misc.mem_debug_overlay){
@@ -925,12 +950,13 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 #else
             const u32 mem_usage= static_cast<u32>(meminfo_sys_mem_usage(100.f));
             const uint64_t gpu_usage= meminfo_gpu_mem_usage_kb();
+            const std::string pool_stats= rpcs3::memory_governor::format_pool_stats();
             if(gpu_usage!=0)
-                rsx::overlays::set_debug_overlay_text( fmt::format("total usage: %02u%%\n gpu usage: %2f GB"
-                                                                   ,mem_usage,gpu_usage/1024.f/1024.f));
+                rsx::overlays::set_debug_overlay_text( fmt::format("total usage: %02u%%\n gpu usage: %2f GB\n%s"
+                                                                   ,mem_usage,gpu_usage/1024.f/1024.f,pool_stats));
             else
-                rsx::overlays::set_debug_overlay_text( fmt::format("total usage: %02u%%"
-                                                                   ,mem_usage));
+                rsx::overlays::set_debug_overlay_text( fmt::format("total usage: %02u%%\n%s"
+                                                                   ,mem_usage,pool_stats));
 #endif
         }
 
@@ -214,7 +214,7 @@ namespace vk
 			// TODO: Alternatively, use VK_EXT_host_pool_reset to reset an old pool with no references and swap that in
 			if (vk::is_renderpass_open(cmd))
 			{
-				vk::end_renderpass(cmd);
+				vk::end_renderpass(cmd, vk::renderpass_break_reason::query_scope);
 			}
 
 			reallocate_pool(cmd);
@@ -19,12 +19,15 @@ namespace vk
 	shared_mutex g_renderpass_cache_mutex;
 	std::unordered_map<u64, VkRenderPass> g_renderpass_cache;
 
+	renderpass_stats_t g_renderpass_stats;
+
 	// Key structure
 	// 0-7 color_format
 	// 8-15 depth_format
 	// 16-21 sample_counts
 	// 22-36 current layouts
 	// 37-41 input attachments
+	// 42-46 attachments whose contents are discarded on load
 	union renderpass_key_blob
 	{
 	private:
@@ -69,6 +72,7 @@ namespace vk
 			u64 sample_count  : 6;
 			u64 layout_blob   : 15;
 			u64 input_attachments_mask : 5;
+			u64 load_discard_mask : 5;
 		};
 
 		renderpass_key_blob(u64 encoded_) : encoded(encoded_)
@@ -224,6 +228,13 @@ namespace vk
 		return key.encoded;
 	}
 
+	u64 get_renderpass_discard_key(u64 renderpass_key, u32 discard_attachments_mask)
+	{
+		renderpass_key_blob key(renderpass_key);
+		key.load_discard_mask = discard_attachments_mask & 0x1F;
+		return key.encoded;
+	}
+
 	VkRenderPass get_renderpass(VkDevice dev, u64 renderpass_key)
 	{
 		// 99.999% of checks will go through this block once on-disk shader cache has loaded
@@ -271,7 +282,7 @@ namespace vk
 			VkAttachmentDescription color_attachment_description = {};
 			color_attachment_description.format = color_format;
 			color_attachment_description.samples = samples;
-			color_attachment_description.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+			color_attachment_description.loadOp = (key.load_discard_mask & (1ull << attachment_count)) ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD;
 			color_attachment_description.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 			color_attachment_description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			color_attachment_description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -284,13 +295,20 @@ namespace vk
 
 		if (depth_format)
 		{
+			// Skip loading the old contents if the whole attachment is about to be overwritten.
+			// On tiled GPUs this saves a full read of the attachment into tile memory.
+			const auto depth_load_op = (key.load_discard_mask & (1ull << attachment_count)) ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD;
+
+			// Formats without a stencil aspect do not need the stencil contents preserved
+			const bool has_stencil = (depth_format == VK_FORMAT_D24_UNORM_S8_UINT || depth_format == VK_FORMAT_D32_SFLOAT_S8_UINT);
+
 			VkAttachmentDescription depth_attachment_description = {};
 			depth_attachment_description.format = depth_format;
 			depth_attachment_description.samples = samples;
-			depth_attachment_description.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+			depth_attachment_description.loadOp = depth_load_op;
 			depth_attachment_description.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-			depth_attachment_description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-			depth_attachment_description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+			depth_attachment_description.stencilLoadOp = has_stencil ? depth_load_op : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			depth_attachment_description.stencilStoreOp = has_stencil ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
 			depth_attachment_description.initialLayout = dsv_layout;
 			depth_attachment_description.finalLayout = dsv_layout;
 			attachments.push_back(depth_attachment_description);
@@ -341,7 +359,7 @@ namespace vk
 		g_renderpass_cache.clear();
 	}
 
-	void begin_renderpass(const vk::command_buffer& cmd, VkRenderPass pass, VkFramebuffer target, const coordu& framebuffer_region)
+	void begin_renderpass(const vk::command_buffer& cmd, VkRenderPass pass, VkFramebuffer target, const coordu& framebuffer_region, VkRenderPass load_discard_pass)
 	{
 		auto& renderpass_info = g_current_renderpass[cmd];
 		if (renderpass_info.pass == pass && renderpass_info.fbo == target)
@@ -350,12 +368,19 @@ namespace vk
 		}
 		else if (renderpass_info.pass != VK_NULL_HANDLE)
 		{
-			end_renderpass(cmd);
+			end_renderpass(cmd, renderpass_break_reason::pass_mismatch);
+		}
+
+		g_renderpass_stats.begin_count++;
+
+		if (load_discard_pass)
+		{
+			g_renderpass_stats.discarded_load_count++;
 		}
 
 		VkRenderPassBeginInfo rp_begin = {};
 		rp_begin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		rp_begin.renderPass = pass;
+		rp_begin.renderPass = load_discard_pass ? load_discard_pass : pass;
 		rp_begin.framebuffer = target;
 		rp_begin.renderArea.offset.x = static_cast<s32>(framebuffer_region.x);
 		rp_begin.renderArea.offset.y = static_cast<s32>(framebuffer_region.y);
@@ -363,6 +388,8 @@ namespace vk
 		rp_begin.renderArea.extent.height = framebuffer_region.height;
 
 		_vkCmdBeginRenderPass(cmd, &rp_begin, VK_SUBPASS_CONTENTS_INLINE);
+
+		// Track the base pass so that compatible draws continue in this scope
 		renderpass_info = { pass, target };
 	}
 
@@ -377,10 +404,11 @@ namespace vk
 		begin_renderpass(cmd, g_cached_renderpass, target, framebuffer_region);
 	}
 
-	void end_renderpass(const vk::command_buffer& cmd)
+	void end_renderpass(const vk::command_buffer& cmd, renderpass_break_reason reason)
 	{
 		_vkCmdEndRenderPass(cmd);
 		g_current_renderpass[cmd] = {};
+		g_renderpass_stats.break_count[static_cast<u32>(reason)]++;
 	}
 
 	bool is_renderpass_open(const vk::command_buffer& cmd)
@@ -393,4 +421,41 @@ namespace vk
 		const auto& active = g_current_renderpass[cmd];
 		op(cmd, active.pass, active.fbo);
 	}
+
+	u32 renderpass_stats_t::total_breaks() const
+	{
+		u32 result = 0;
+		for (const auto& count : break_count)
+		{
+			result += count;
+		}
+
+		return result;
+	}
+
+	std::string renderpass_stats_t::to_string() const
+	{
+		const auto get = [this](renderpass_break_reason reason)
+		{
+			return break_count[static_cast<u32>(reason)];
+		};
+
+		return fmt::format("%u begun, %u breaks (%u barrier, %u layout, %u transfer, %u compute, %u query, %u mismatch, %u submit), %u loads skipped",
+			begin_count, total_breaks(),
+			get(renderpass_break_reason::barrier) + get(renderpass_break_reason::unspecified),
+			get(renderpass_break_reason::layout_transition), get(renderpass_break_reason::transfer),
+			get(renderpass_break_reason::compute), get(renderpass_break_reason::query_scope),
+			get(renderpass_break_reason::pass_mismatch), get(renderpass_break_reason::submit),
+			discarded_load_count);
+	}
+
+	renderpass_stats_t get_renderpass_stats()
+	{
+		return g_renderpass_stats;
+	}
+
+	void reset_renderpass_stats()
+	{
+		g_renderpass_stats = {};
+	}
 }
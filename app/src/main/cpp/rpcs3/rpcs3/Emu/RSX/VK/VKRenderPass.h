@@ -3,6 +3,8 @@
 #include "VulkanAPI.h"
 #include "Utilities/geometry.h"
 
+#include <array>
+
 namespace vk
 {
 	class image;
@@ -13,15 +15,47 @@ namespace vk
 	u64 get_renderpass_key(VkFormat surface_format);
 	VkRenderPass get_renderpass(VkDevice dev, u64 renderpass_key);
 
+	// Returns a key for a variant of the renderpass that does not load the previous contents of the attachments in the mask.
+	// The variant is compatible with the original and can be used to open a scope for pipelines built against it.
+	u64 get_renderpass_discard_key(u64 renderpass_key, u32 discard_attachments_mask);
+
 	void clear_renderpass_cache(VkDevice dev);
 
+	enum class renderpass_break_reason : u8
+	{
+		unspecified = 0,
+		barrier,            // Pipeline barrier outside of the renderpass
+		layout_transition,  // Attachment or texture layout change
+		transfer,           // Copy, blit or clear outside of the renderpass
+		compute,            // Compute dispatch
+		query_scope,        // Strict query scope rules
+		pass_mismatch,      // Draw targets a different renderpass or framebuffer
+		submit,             // Command buffer flush
+
+		count
+	};
+
+	struct renderpass_stats_t
+	{
+		u32 begin_count = 0;
+		u32 discarded_load_count = 0;
+		std::array<u32, static_cast<u32>(renderpass_break_reason::count)> break_count{};
+
+		u32 total_breaks() const;
+		std::string to_string() const;
+	};
+
 	// Renderpass scope management helpers.
 	// NOTE: These are not thread safe by design.
 	void begin_renderpass(VkDevice dev, const vk::command_buffer& cmd, u64 renderpass_key, VkFramebuffer target, const coordu& framebuffer_region);
-	void begin_renderpass(const vk::command_buffer& cmd, VkRenderPass pass, VkFramebuffer target, const coordu& framebuffer_region);
-	void end_renderpass(const vk::command_buffer& cmd);
+	void begin_renderpass(const vk::command_buffer& cmd, VkRenderPass pass, VkFramebuffer target, const coordu& framebuffer_region, VkRenderPass load_discard_pass = VK_NULL_HANDLE);
+	void end_renderpass(const vk::command_buffer& cmd, renderpass_break_reason reason = renderpass_break_reason::unspecified);
 	bool is_renderpass_open(const vk::command_buffer& cmd);
 
+	// Statistics are collected per frame; the caller is responsible for resetting them at frame boundaries
+	renderpass_stats_t get_renderpass_stats();
+	void reset_renderpass_stats();
+
 	using renderpass_op_callback_t = std::function<void(const vk::command_buffer&, VkRenderPass, VkFramebuffer)>;
 	void renderpass_op(const vk::command_buffer& cmd, const renderpass_op_callback_t& op);
 }
@@ -15,12 +15,90 @@ namespace vk
 			auto obj = vk::disposable_t::make(buf);
 			vk::get_resource_manager()->dispose(obj);
 		}
+
+		struct pooled_resolve_image_t
+		{
+			u64 release_frame_id;
+			std::unique_ptr<vk::viewable_image> image;
+		};
+
+		// Only touched from the RSX thread
+		std::vector<pooled_resolve_image_t> g_resolve_image_pool;
+		rsx::surface_pool_stats_t g_resolve_image_pool_stats;
+
+		constexpr usz max_pooled_resolve_images = 8;
+		constexpr u64 max_pooled_resolve_image_age = 120; // Frames
+
+		std::unique_ptr<vk::viewable_image> acquire_resolve_image(VkFormat format, u32 width, u32 height, VkImageUsageFlags usage, const VkComponentMapping& component_map)
+		{
+			for (auto it = g_resolve_image_pool.begin(); it != g_resolve_image_pool.end(); ++it)
+			{
+				const auto& image = it->image;
+				if (image->format() != format ||
+					image->width() != width ||
+					image->height() != height ||
+					image->info.usage != usage)
+				{
+					continue;
+				}
+
+				// Views are created with the native component map baked in
+				const auto& map = image->native_component_map;
+				if (map.r != component_map.r || map.g != component_map.g || map.b != component_map.b || map.a != component_map.a)
+				{
+					continue;
+				}
+
+				auto result = std::move(it->image);
+				g_resolve_image_pool.erase(it);
+				g_resolve_image_pool_stats.pooled_allocations++;
+				return result;
+			}
+
+			g_resolve_image_pool_stats.fresh_allocations++;
+			return {};
+		}
+
+		void release_resolve_image(std::unique_ptr<vk::viewable_image>& image)
+		{
+			if (g_resolve_image_pool.size() >= max_pooled_resolve_images)
+			{
+				// Drop the oldest entry
+				g_resolve_image_pool.erase(g_resolve_image_pool.begin());
+			}
+
+			g_resolve_image_pool.push_back({ vk::get_current_frame_id(), std::move(image) });
+		}
+
+		void trim_resolve_image_pool(rsx::problem_severity severity)
+		{
+			if (severity >= rsx::problem_severity::moderate)
+			{
+				g_resolve_image_pool.clear();
+				return;
+			}
+
+			const u64 current_frame_id = vk::get_current_frame_id();
+			g_resolve_image_pool.erase(std::remove_if(g_resolve_image_pool.begin(), g_resolve_image_pool.end(),
+				FN((current_frame_id - x.release_frame_id) > max_pooled_resolve_image_age)), g_resolve_image_pool.end());
+		}
+
+		void clear_resolve_image_pool()
+		{
+			g_resolve_image_pool.clear();
+		}
+
+		const rsx::surface_pool_stats_t& get_resolve_image_pool_stats()
+		{
+			return g_resolve_image_pool_stats;
+		}
 	}
 
 	void surface_cache::destroy()
 	{
 		invalidate_all();
 		invalidated_resources.clear();
+		surface_cache_utils::clear_resolve_image_pool();
 	}
 
 	u64 surface_cache::get_surface_cache_memory_quota(u64 total_device_memory)
@@ -182,6 +260,12 @@ namespace vk
 			}
 		});
 
+		surface_cache_utils::trim_resolve_image_pool(memory_pressure);
+
+		// Keep invalidated surfaces around for longer while there is room for them.
+		// Transient targets are often recreated with the same properties a few frames later.
+		const u8 max_idle_checks = is_overallocated() ? 2 : 8;
+
 		const u64 last_finished_frame = vk::get_last_completed_frame_id();
 		invalidated_resources.remove_if([&](std::unique_ptr<vk::render_target>& rtt)
 		{
@@ -212,12 +296,15 @@ namespace vk
 				vk::get_resource_manager()->dispose(rtt->resolve_surface);
 			}
 
+			bool remove = false;
 			switch (memory_pressure)
 			{
 			case rsx::problem_severity::low:
-				return (rtt->unused_check_count() >= 2);
+				remove = (rtt->unused_check_count() >= max_idle_checks);
+				break;
 			case rsx::problem_severity::moderate:
-				return (rtt->unused_check_count() >= 1);
+				remove = (rtt->unused_check_count() >= 1);
+				break;
 			case rsx::problem_severity::severe:
 			case rsx::problem_severity::fatal:
 				// We're almost dead anyway. Remove forcefully.
@@ -226,6 +313,14 @@ namespace vk
 			default:
 				fmt::throw_exception("Unreachable");
 			}
+
+			if (remove && rtt->resolve_surface)
+			{
+				// The surface is done, but its resolve target can serve another MSAA surface
+				surface_cache_utils::release_resolve_image(rtt->resolve_surface);
+			}
+
+			return remove;
 		});
 	}
 
@@ -304,6 +399,14 @@ namespace vk
 			VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 			usage |= (this->info.usage & (VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT));
 
+			resolve_surface = surface_cache_utils::acquire_resolve_image(format(), resolve_w, resolve_h, usage, native_component_map);
+			if (resolve_surface)
+			{
+				// Recycled; contents are undefined just like a new allocation
+				resolve_surface->change_layout(cmd, VK_IMAGE_LAYOUT_GENERAL);
+				return resolve_surface.get();
+			}
+
 			resolve_surface.reset(new vk::viewable_image(
 				*g_render_device,
 				g_render_device->get_memory_mapping().device_local,
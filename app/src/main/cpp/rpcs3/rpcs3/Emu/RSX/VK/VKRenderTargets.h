@@ -16,6 +16,14 @@ namespace vk
 	namespace surface_cache_utils
 	{
 		void dispose(vk::buffer* buf);
+
+		// Resolve targets of retired surfaces are kept around for a while and handed out to other MSAA surfaces.
+		// Returns null if no matching image is available.
+		std::unique_ptr<vk::viewable_image> acquire_resolve_image(VkFormat format, u32 width, u32 height, VkImageUsageFlags usage, const VkComponentMapping& component_map);
+		void release_resolve_image(std::unique_ptr<vk::viewable_image>& image);
+		void trim_resolve_image_pool(rsx::problem_severity severity);
+		void clear_resolve_image_pool();
+		const rsx::surface_pool_stats_t& get_resolve_image_pool_stats();
 	}
 
 	void resolve_image(vk::command_buffer& cmd, vk::viewable_image* dst, vk::viewable_image* src);
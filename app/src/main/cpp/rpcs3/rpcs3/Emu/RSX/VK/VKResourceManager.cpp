@@ -3,6 +3,9 @@
 #include "VKGSRender.h"
 #include "VKCommandStream.h"
 
+#include "Emu/Cell/timers.hpp"
+#include "Emu/memory_governor.hpp"
+
 namespace vk
 {
 	struct vmm_memory_stats
@@ -11,6 +14,12 @@ namespace vk
 		std::unordered_map<uptr, atomic_t<u64>> memory_usage;
 		std::unordered_map<vmm_allocation_pool, atomic_t<u64>> pool_usage;
 
+		// Driver heap budget, queried at most every s_vmm_driver_load_sample_interval_us (the severity is checked several times per frame)
+		f32 driver_load = -1.f;
+		u64 driver_load_sample_time = 0;
+
+		u64 last_fatal_response_time = 0;
+
 		void clear()
 		{
 			if (!allocations.empty())
@@ -26,6 +35,10 @@ namespace vk
 			allocations.clear();
 			memory_usage.clear();
 			pool_usage.clear();
+
+			driver_load = -1.f;
+			driver_load_sample_time = 0;
+			last_fatal_response_time = 0;
 		}
 	}
 	g_vmm_stats;
@@ -35,6 +48,8 @@ namespace vk
 	atomic_t<u64> g_last_completed_event;
 
 	constexpr u64 s_vmm_warn_threshold_size = 2000 * 0x100000; // Warn if allocation on a single heap exceeds this value
+	constexpr u64 s_vmm_driver_load_sample_interval_us = 250'000;
+	constexpr u64 s_vmm_fatal_response_cooldown_us = 1'000'000; // A fatal response hard syncs the queue, don't repeat it every frame
 
 	resource_manager* get_resource_manager()
 	{
@@ -182,7 +197,18 @@ namespace vk
 
 	rsx::problem_severity vmm_determine_memory_load_severity()
 	{
-		const auto vmm_load = get_current_mem_allocator()->get_memory_usage();
+		// The allocator only sees our own allocations against the configured limit.
+		// With VK_EXT_memory_budget the driver also accounts for other processes sharing the heap, which matters on unified memory devices.
+		const auto allocator_load = get_current_mem_allocator()->get_memory_usage();
+		const u64 now = get_system_time();
+		if (!g_vmm_stats.driver_load_sample_time || (now - g_vmm_stats.driver_load_sample_time) >= s_vmm_driver_load_sample_interval_us)
+		{
+			g_vmm_stats.driver_load = get_current_renderer()->gpu().get_device_local_heap_load();
+			g_vmm_stats.driver_load_sample_time = now;
+		}
+
+		const auto driver_load = g_vmm_stats.driver_load;
+		const auto vmm_load = std::max(allocator_load, driver_load);
 		rsx::problem_severity load_severity = rsx::problem_severity::low;
 
 		// Fragmentation tuning
@@ -218,7 +244,11 @@ namespace vk
 			const auto mem_threshold_1 = static_cast<u64>(256 * res_scale * res_scale) * _1M;
 			const auto mem_threshold_2 = static_cast<u64>(64 * res_scale * res_scale) * _1M;
 
-			if (local_memory_usage < (mem_info.device_local_total_bytes / 2) ||                   // Less than 50% VRAM usage OR
+			if (driver_load > 75.f)
+			{
+				// The driver confirms the heap is actually running out, our own usage figures are irrelevant
+			}
+			else if (local_memory_usage < (mem_info.device_local_total_bytes / 2) ||              // Less than 50% VRAM usage OR
 				(mem_info.device_local_total_bytes - local_memory_usage) > mem_threshold_1)       // Enough to hold all required resources left
 			{
 				// Lower severity to avoid slowing performance too much
@@ -255,8 +285,34 @@ namespace vk
 
 	void vmm_check_memory_usage()
 	{
-		if (const auto load_severity = vmm_determine_memory_load_severity();
-			load_severity >= rsx::problem_severity::moderate)
+		using rpcs3::memory_governor::pressure_level;
+		static_assert(static_cast<u8>(pressure_level::critical) == static_cast<u8>(rsx::problem_severity::fatal));
+
+		// Let the governor fold in host memory pressure and trim host-side pools first.
+		// Both enums are ordered the same way (low/none -> fatal/critical).
+		const auto device_severity = vmm_determine_memory_load_severity();
+		const auto governor_level = rpcs3::memory_governor::update(static_cast<pressure_level>(device_severity));
+
+		// Host pressure alone does not justify the fatal path (hard sync, eviction of in-use textures and VRAM spills),
+		// those only help if the device heap itself is running out
+		auto load_severity = std::max(device_severity, std::min(static_cast<rsx::problem_severity>(governor_level), rsx::problem_severity::severe));
+
+		if (load_severity >= rsx::problem_severity::fatal)
+		{
+			const u64 now = get_system_time();
+
+			if (g_vmm_stats.last_fatal_response_time && (now - g_vmm_stats.last_fatal_response_time) < s_vmm_fatal_response_cooldown_us)
+			{
+				// Give the previous response time to take effect
+				load_severity = rsx::problem_severity::severe;
+			}
+			else
+			{
+				g_vmm_stats.last_fatal_response_time = now;
+			}
+		}
+
+		if (load_severity >= rsx::problem_severity::moderate)
 		{
 			vmm_handle_memory_pressure(load_severity);
 		}
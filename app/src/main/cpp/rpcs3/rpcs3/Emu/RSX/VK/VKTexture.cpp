@@ -37,13 +37,46 @@ namespace vk
     {
         vk::get_compute_task<vk::cs_shuffle_ror8>()->run(cmd, buf, data_length, data_offset);
     }
-#if 0
-    template<int bc_ver>
-    static void gpu_decompress_bc(const vk::command_buffer& cmd, vk::buffer* buf, u32 element_size, u32 data_offset, u32 data_length)
-    {
 
-    }
-#endif
+	// Decodes tightly packed DXT blocks into 32-bit texels. The output is placed after the compressed input.
+	// Returns the end offset of the decoded data.
+	static u32 gpu_decode_bc_sections_impl(const vk::command_buffer& cmd, vk::buffer* scratch_buf, u32 dst_offset, u32 require_mth, std::vector<VkBufferImageCopy>& sections)
+	{
+		using require_mth_t = rsx::texture_memory_info_require_mth;
+		vk::cs_bc_decode_base* job = nullptr;
+
+		if (require_mth & require_mth_t::decode_bc1)
+		{
+			job = vk::get_compute_task<vk::cs_bc_decode_task<1>>();
+		}
+		else if (require_mth & require_mth_t::decode_bc2)
+		{
+			job = vk::get_compute_task<vk::cs_bc_decode_task<2>>();
+		}
+		else
+		{
+			job = vk::get_compute_task<vk::cs_bc_decode_task<3>>();
+		}
+
+		for (auto& section : sections)
+		{
+			ensure(section.bufferRowLength);
+
+			// Align output to 128-byte boundary to keep some drivers happy
+			dst_offset = utils::align(dst_offset, 128);
+
+			const u32 src_offset = static_cast<u32>(section.bufferOffset);
+			job->run(cmd, scratch_buf, dst_offset, scratch_buf, src_offset,
+				section.imageExtent.width, section.imageExtent.height, section.imageExtent.depth, section.bufferRowLength);
+
+			section.bufferOffset = dst_offset;
+			dst_offset += section.bufferRowLength * section.imageExtent.height * section.imageExtent.depth * 4;
+		}
+
+		ensure(dst_offset <= scratch_buf->size());
+		return dst_offset;
+	}
+
 	u64 calculate_working_buffer_size(u64 base_size, VkImageAspectFlags aspect)
 	{
 		if (aspect & (VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT))
@@ -68,7 +101,7 @@ namespace vk
 
 		if (vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::transfer);
 		}
 
 		ensure((region.imageExtent.width + region.imageOffset.x) <= src->width());
@@ -233,7 +266,7 @@ namespace vk
 
 		if (vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::transfer);
 		}
 
 		switch (dst->format())
@@ -360,7 +393,7 @@ namespace vk
 
 		if (vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::transfer);
 		}
 
 		if (src != dst) [[likely]]
@@ -519,7 +552,7 @@ namespace vk
 
 		if (vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::transfer);
 		}
 
 		if (src != dst)
@@ -561,7 +594,7 @@ namespace vk
 
 		if (vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::transfer);
 		}
 
 		//TODO: Use an array of offsets/dimensions for mipmapped blits (mipmap count > 1) since subimages will have different dimensions
@@ -940,7 +973,7 @@ namespace vk
 		{
 			if (vk::is_renderpass_open(primary_cb))
 			{
-				vk::end_renderpass(primary_cb);
+				vk::end_renderpass(primary_cb, vk::renderpass_break_reason::transfer);
 			}
 
 			pcmd = &primary_cb;
@@ -1043,6 +1076,14 @@ namespace vk
 				caps.supports_zero_copy = caps.supports_byteswap;
 				caps.supports_vtc_decoding = false;
 				check_caps = false;
+
+				// The GPU decode pass covers every region of the image, a single unsuitable level keeps the whole mip chain on the CPU
+				if (caps.supports_zero_copy && !caps.supports_dxt && !(image_setup_flags & source_is_gpu_resident) &&
+					(format == CELL_GCM_TEXTURE_COMPRESSED_DXT1 || format == CELL_GCM_TEXTURE_COMPRESSED_DXT23 || format == CELL_GCM_TEXTURE_COMPRESSED_DXT45) &&
+					!rsx::can_gpu_decode_bc_image(subresource_layout))
+				{
+					caps.supports_zero_copy = false;
+				}
 			}
 
 			auto buf_allocator = [&](usz) -> std::tuple<void*, usz>
@@ -1147,14 +1188,11 @@ namespace vk
                         //FIXME 计算正确的大小
                         scratch_buf_size +=  scratch_buf_size*2;
                     }
-                    else if(opt.require_mth&require_mth::decode_bc1){
-                        //FIXME 计算正确的大小
-                        scratch_buf_size +=  scratch_buf_size*8;
-                    }
-                    else if((opt.require_mth&require_mth::decode_bc2)
-                       ||(opt.require_mth&require_mth::decode_bc3)){
-                        //FIXME 计算正确的大小
-                        scratch_buf_size +=  scratch_buf_size*4;
+                    else if (opt.require_mth & (require_mth::decode_bc1 | require_mth::decode_bc2 | require_mth::decode_bc3))
+                    {
+                        // image_linear_size already describes the decoded texels. The compressed input fits in that region
+                        // and the decoder writes its output after it, so the same amount of memory is needed again.
+                        scratch_buf_size += scratch_buf_size;
                     }
 
 					if (requires_depth_processing)
@@ -1260,8 +1298,12 @@ namespace vk
 		{
 			gpu_swap_bytes_impl(cmd2, scratch_buf, opt.element_size, 0, scratch_offset);
 		}
-        else if (opt.require_mth&require_mth::decode_bc3){
+        else if (opt.require_mth & (require_mth::decode_bc1 | require_mth::decode_bc2 | require_mth::decode_bc3))
+        {
+            const auto decoded_end = gpu_decode_bc_sections_impl(cmd2, scratch_buf, scratch_offset, opt.require_mth, copy_regions);
 
+            // The barrier below covers [block_start, block_start + scratch_offset). Resize it to the decoded data.
+            scratch_offset = decoded_end - static_cast<u32>(copy_regions.front().bufferOffset);
         }
 
 		// CopyBufferToImage routines
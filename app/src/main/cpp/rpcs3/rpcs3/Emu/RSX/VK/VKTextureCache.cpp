@@ -81,7 +81,7 @@ namespace vk
 
 		if (vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::transfer);
 		}
 
 		src->push_layout(cmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
@@ -1118,7 +1118,7 @@ namespace vk
 		{
 			if (vk::is_renderpass_open(cmd))
 			{
-				vk::end_renderpass(cmd);
+				vk::end_renderpass(cmd, vk::renderpass_break_reason::transfer);
 			}
 		}
 
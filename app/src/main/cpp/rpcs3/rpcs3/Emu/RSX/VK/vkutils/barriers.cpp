@@ -17,7 +17,7 @@ namespace vk
 	{
 		if (!preserve_renderpass && vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::barrier);
 		}
 
 		VkImageMemoryBarrier barrier = {};
@@ -44,7 +44,7 @@ namespace vk
 	{
 		if (!preserve_renderpass && vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::barrier);
 		}
 
 		VkBufferMemoryBarrier barrier = {};
@@ -68,7 +68,7 @@ namespace vk
 	{
 		if (!preserve_renderpass && vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::barrier);
 		}
 
 		VkMemoryBarrier barrier = {};
@@ -91,7 +91,7 @@ namespace vk
 		// TODO: This likely throws out hw optimizations on the rest of the renderpass, manage carefully
 		if (!preserve_renderpass && vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::barrier);
 		}
 
 		VkAccessFlags src_access;
@@ -6,15 +6,39 @@
 #include "../VKHelpers.h"
 #include "../VKResourceManager.h"
 #include "Emu/IdManager.h"
+#include "Utilities/File.h"
+#include "Utilities/StrUtil.h"
 
+#include <charconv>
 #include <memory>
+#include <unordered_map>
 
 namespace vk
 {
 	data_heap g_upload_heap;
 
+	// Recorded high-water marks, keyed by heap name
+	std::unordered_map<std::string, usz> g_heap_size_hints;
+
+	namespace
+	{
+		constexpr usz heap_size_granularity = 16 * 0x100000;
+		constexpr usz heap_size_limit = 1024 * 0x100000;
+	}
+
 	void data_heap::create(VkBufferUsageFlags usage, usz size, const char* name, usz guard, VkBool32 notify)
 	{
+		// Requested size is the floor for dynamic sizing
+		initial_size = size;
+
+		if (const auto found = g_heap_size_hints.find(name);
+			found != g_heap_size_hints.end())
+		{
+			// Start with enough headroom over the recorded high-water mark to avoid growing again
+			const usz hinted_size = std::min(utils::align(found->second + found->second / 2 + guard, heap_size_granularity), heap_size_limit);
+			size = std::max(size, hinted_size);
+		}
+
 		::data_heap::init(size, name, guard);
 
 		const auto& memory_map = g_render_device->get_memory_mapping();
@@ -34,8 +58,11 @@ namespace vk
 
 		heap = std::make_unique<buffer>(*g_render_device, size, memory_index, memory_flags, usage, 0, VMM_ALLOCATION_POOL_SYSTEM);
 
-		initial_size = size;
 		notify_on_grow = bool(notify);
+		m_high_water_mark = 0;
+		m_idle_window_peak = 0;
+		m_pressure_frames = 0;
+		m_idle_frames = 0;
 	}
 
 	void data_heap::destroy()
@@ -49,6 +76,36 @@ namespace vk
 		shadow.reset();
 	}
 
+	void data_heap::resize(usz new_size)
+	{
+		// Wait for DMA activity to end
+		g_fxo->get<rsx::dma_manager>().sync();
+
+		if (mapped)
+		{
+			// Force reset mapping
+			unmap(true);
+		}
+
+		VkBufferUsageFlags usage = heap->info.usage;
+		const auto& memory_map = g_render_device->get_memory_mapping();
+
+		VkFlags memory_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		auto memory_index = memory_map.host_visible_coherent;
+
+		// Update heap information and reset the allocator
+		::data_heap::init(new_size, m_name, m_min_guard_size);
+
+		// Discard old heap and create a new one. Old heap will be garbage collected when no longer needed
+		get_resource_manager()->dispose(heap);
+		heap = std::make_unique<buffer>(*g_render_device, new_size, memory_index, memory_flags, usage, 0, VMM_ALLOCATION_POOL_SYSTEM);
+
+		if (notify_on_grow)
+		{
+			raise_status_interrupt(vk::heap_changed);
+		}
+	}
+
 	bool data_heap::grow(usz size)
 	{
 		if (shadow)
@@ -59,43 +116,84 @@ namespace vk
 		}
 
 		// Create new heap. All sizes are aligned up by 64M, upto 1GiB
-		const usz size_limit = 1024 * 0x100000;
 		usz aligned_new_size = utils::align(m_size + size, 64 * 0x100000);
 
-		if (aligned_new_size >= size_limit)
+		if (aligned_new_size >= heap_size_limit)
 		{
 			// Too large, try to swap out the heap instead of growing.
 			rsx_log.error("[%s] Pool limit was reached. Will attempt to swap out the current heap.", m_name);
-			aligned_new_size = size_limit;
+			aligned_new_size = heap_size_limit;
 		}
 
-		// Wait for DMA activity to end
-		g_fxo->get<rsx::dma_manager>().sync();
+		// Remember how far we had to go so that the next boot starts there
+		m_high_water_mark = std::max(m_high_water_mark, m_current_allocated_size + size);
 
-		if (mapped)
+		resize(aligned_new_size);
+		return true;
+	}
+
+	bool data_heap::rebalance()
+	{
+		if (!heap || shadow)
 		{
-			// Force reset mapping
-			unmap(true);
+			return false;
 		}
 
-		VkBufferUsageFlags usage = heap->info.usage;
-		const auto& memory_map = g_render_device->get_memory_mapping();
+		// Number of consecutive frames spent above/below the thresholds before resizing
+		constexpr u32 pressure_frames_to_grow = 3;
+		constexpr u32 idle_frames_to_shrink = 1800;
 
-		VkFlags memory_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-		auto memory_index = memory_map.host_visible_coherent;
+		const usz peak = reset_peak_allocated_size();
+		const usz guard_length = std::max(m_min_guard_size, m_largest_allocated_pool);
+		m_high_water_mark = std::max(m_high_water_mark, peak);
 
-		// Update heap information and reset the allocator
-		::data_heap::init(aligned_new_size, m_name, m_min_guard_size);
+		if ((peak + guard_length) >= (m_size / 4) * 3)
+		{
+			// Running hot. Grow now while we're at a frame boundary rather than waiting for an allocation to fail mid-frame.
+			m_idle_frames = 0;
+			m_idle_window_peak = 0;
 
-		// Discard old heap and create a new one. Old heap will be garbage collected when no longer needed
-		get_resource_manager()->dispose(heap);
-		heap = std::make_unique<buffer>(*g_render_device, aligned_new_size, memory_index, memory_flags, usage, 0, VMM_ALLOCATION_POOL_SYSTEM);
+			if (++m_pressure_frames < pressure_frames_to_grow || m_size >= heap_size_limit)
+			{
+				return false;
+			}
 
-		if (notify_on_grow)
+			const usz new_size = std::min(utils::align(m_size * 2, heap_size_granularity), heap_size_limit);
+			rsx_log.notice("[%s] Sustained heap pressure, growing from %lluM to %lluM", m_name, m_size / 0x100000, new_size / 0x100000);
+
+			m_pressure_frames = 0;
+			resize(new_size);
+			return true;
+		}
+
+		m_pressure_frames = 0;
+
+		if (peak >= m_size / 4 || m_size <= initial_size)
 		{
-			raise_status_interrupt(vk::heap_changed);
+			m_idle_frames = 0;
+			m_idle_window_peak = 0;
+			return false;
 		}
 
+		// Mostly idle. Give back memory once this has been the case for a while.
+		m_idle_window_peak = std::max(m_idle_window_peak, peak);
+
+		if (++m_idle_frames < idle_frames_to_shrink)
+		{
+			return false;
+		}
+
+		const usz new_size = std::max(initial_size, utils::align(m_idle_window_peak * 2 + guard_length, heap_size_granularity));
+		m_idle_frames = 0;
+		m_idle_window_peak = 0;
+
+		if (new_size >= m_size)
+		{
+			return false;
+		}
+
+		rsx_log.notice("[%s] Heap has been idle, shrinking from %lluM to %lluM", m_name, m_size / 0x100000, new_size / 0x100000);
+		resize(new_size);
 		return true;
 	}
 
@@ -168,6 +266,64 @@ namespace vk
 		return true;
 	}
 
+	void load_heap_size_hints(const std::string& path)
+	{
+		g_heap_size_hints.clear();
+
+		fs::file f(path);
+		if (!f)
+		{
+			return;
+		}
+
+		// One "name:bytes" pair per line
+		for (const auto& line : fmt::split(f.to_string(), { "\n" }))
+		{
+			const auto separator = line.find_last_of(':');
+			if (separator == umax)
+			{
+				continue;
+			}
+
+			usz value = 0;
+			const auto value_str = std::string_view(line).substr(separator + 1);
+			if (std::from_chars(value_str.data(), value_str.data() + value_str.size(), value).ec != std::errc{})
+			{
+				continue;
+			}
+
+			g_heap_size_hints[line.substr(0, separator)] = value;
+		}
+	}
+
+	void save_heap_size_hints(const std::string& path, std::initializer_list<const data_heap*> heaps)
+	{
+		std::string data;
+
+		for (const auto heap : heaps)
+		{
+			if (!heap->heap)
+			{
+				continue;
+			}
+
+			// Keep the largest mark ever recorded; a quiet session shouldn't undo what a heavy one learned
+			usz value = heap->get_high_water_mark();
+			if (const auto found = g_heap_size_hints.find(heap->get_name());
+				found != g_heap_size_hints.end())
+			{
+				value = std::max(value, found->second);
+			}
+
+			fmt::append(data, "%s:%llu\n", heap->get_name(), value);
+		}
+
+		if (!data.empty() && !fs::write_file(path, fs::rewrite, data))
+		{
+			rsx_log.error("Failed to save heap size hints to '%s' (%s)", path, fs::g_tls_error);
+		}
+	}
+
 	data_heap* get_upload_heap()
 	{
 		if (!g_upload_heap.heap)
@@ -6,6 +6,7 @@
 #include "commands.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace vk
@@ -19,9 +20,17 @@ namespace vk
 
 		bool notify_on_grow = false;
 
+		// Dynamic sizing state
+		usz m_high_water_mark = 0;   // Highest occupancy seen during the heap's lifetime
+		usz m_idle_window_peak = 0;  // Highest occupancy seen since the heap became idle
+		u32 m_pressure_frames = 0;
+		u32 m_idle_frames = 0;
+
 		std::unique_ptr<buffer> shadow;
 		std::vector<VkBufferCopy> dirty_ranges;
 
+		void resize(usz new_size);
+
 	protected:
 		bool grow(usz size) override;
 
@@ -40,10 +49,21 @@ namespace vk
 
 		void sync(const vk::command_buffer& cmd);
 
+		// Frame boundary housekeeping. Grows the heap ahead of time when pressure is sustained so that
+		// allocations don't hit the exhaustion path mid-frame, and shrinks it back after a long idle period.
+		// Returns true if the backing buffer was replaced. All outstanding offsets into the heap are stale in that case.
+		bool rebalance();
+
 		// Properties
 		bool is_dirty() const;
 		bool is_critical() const override;
+		usz get_high_water_mark() const { return m_high_water_mark; }
+		const char* get_name() const { return m_name; }
 	};
 
 	extern data_heap* get_upload_heap();
+
+	// Per-title heap size hints. Heaps created after loading the hints start at the recorded high-water mark.
+	void load_heap_size_hints(const std::string& path);
+	void save_heap_size_hints(const std::string& path, std::initializer_list<const data_heap*> heaps);
 }
@@ -139,6 +139,7 @@ namespace vk
 
 		optional_features_support.debug_utils              = instance_extensions.is_supported(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 		optional_features_support.surface_capabilities_2   = instance_extensions.is_supported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+		optional_features_support.memory_budget            = instance_extensions.is_supported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) && device_extensions.is_supported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
 		// Post-initialization checks
 		if (!custom_border_color_support.swizzle_extension_supported)
@@ -167,6 +168,7 @@ namespace vk
         if(g_cfg.video.vk.debug.disable_texture_compression_bc) optional_features_support.texture_compression_bc = false;
 
         if(g_cfg.video.vk.debug.disable_multidraw) multidraw_support.supported=false;
+        if(g_cfg.video.vk.debug.disable_memory_budget) optional_features_support.memory_budget = false;
 	}
 
 	void physical_device::get_physical_device_properties(bool allow_extensions)
@@ -472,6 +474,38 @@ namespace vk
 		return props.limits;
 	}
 
+	f32 physical_device::get_device_local_heap_load() const
+	{
+		if (!optional_features_support.memory_budget || !_vkGetPhysicalDeviceMemoryProperties2KHR)
+		{
+			return -1.f;
+		}
+
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_props{};
+		budget_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		VkPhysicalDeviceMemoryProperties2KHR memory_props2{};
+		memory_props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+		memory_props2.pNext = &budget_props;
+
+		_vkGetPhysicalDeviceMemoryProperties2KHR(dev, &memory_props2);
+
+		f32 max_load = -1.f;
+		for (u32 i = 0; i < memory_props2.memoryProperties.memoryHeapCount; ++i)
+		{
+			if (!(memory_props2.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ||
+				!budget_props.heapBudget[i])
+			{
+				continue;
+			}
+
+			const f32 this_load = (budget_props.heapUsage[i] * 100.f) / budget_props.heapBudget[i];
+			max_load = std::max(max_load, this_load);
+		}
+
+		return max_load;
+	}
+
 	physical_device::operator VkPhysicalDevice() const
 	{
 		return dev;
@@ -605,6 +639,11 @@ namespace vk
 			requested_extensions.push_back(VK_EXT_DEVICE_FAULT_EXTENSION_NAME);
 		}
 
+		if (pgpu->optional_features_support.memory_budget)
+		{
+			requested_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		}
+
 		enabled_features.robustBufferAccess = VK_TRUE;
 		enabled_features.fullDrawIndexUint32 = VK_TRUE;
 		enabled_features.independentBlend = VK_TRUE;
@@ -101,6 +101,7 @@ namespace vk
 			bool unrestricted_depth_range = false;
 			bool extended_device_fault = false;
 			bool texture_compression_bc = false;
+			bool memory_budget = false;
 		} optional_features_support;
 
 		friend class render_device;
@@ -128,6 +129,10 @@ namespace vk
 		const VkPhysicalDeviceMemoryProperties& get_memory_properties() const;
 		const VkPhysicalDeviceLimits& get_limits() const;
 
+		// Highest usage/budget ratio of the device-local heaps as reported by the driver (VK_EXT_memory_budget).
+		// Unlike the allocator statistics this includes memory held by other processes. Returns a negative value if unsupported.
+		f32 get_device_local_heap_load() const;
+
 		operator VkPhysicalDevice() const;
 		operator VkInstance() const;
 	};
@@ -189,6 +194,7 @@ namespace vk
 		bool get_synchronization2_support() const { return pgpu->optional_features_support.synchronization_2; }
 		bool get_extended_device_fault_support() const { return pgpu->optional_features_support.extended_device_fault; }
 		bool get_texture_compression_bc_support() const { return pgpu->optional_features_support.texture_compression_bc; }
+		bool get_memory_budget_support() const { return pgpu->optional_features_support.memory_budget; }
 
 		u64 get_descriptor_update_after_bind_support() const { return pgpu->descriptor_indexing_support.update_after_bind_mask; }
 		u32 get_descriptor_max_draw_calls() const { return pgpu->descriptor_max_draw_calls; }
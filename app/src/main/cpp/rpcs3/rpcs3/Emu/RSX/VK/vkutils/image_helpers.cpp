@@ -40,7 +40,7 @@ namespace vk
 	{
 		if (vk::is_renderpass_open(cmd))
 		{
-			vk::end_renderpass(cmd);
+			vk::end_renderpass(cmd, vk::renderpass_break_reason::layout_transition);
 		}
 
 		//Prepare an image to match the new layout..
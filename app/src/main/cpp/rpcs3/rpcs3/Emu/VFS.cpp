@@ -951,6 +951,9 @@ bool vfs::host::rename(const std::string& from, const std::string& to, const lv2
 
 	std::vector<std::pair<shared_ptr<lv2_file>, std::string>> escaped_real;
 
+	// Held until the handles are reopened, descriptor I/O only takes the per-file lock
+	std::vector<std::unique_lock<shared_mutex>> file_locks;
+
 	std::unique_lock mp_lock(mp->mutex, std::defer_lock);
 
 	if (lock)
@@ -986,12 +989,15 @@ bool vfs::host::rename(const std::string& from, const std::string& to, const lv2
 
 		if (check_path(escaped))
 		{
+			std::unique_lock file_lock(file.mutex);
+
 			if (!file.file)
 			{
 				return;
 			}
 
 			file.restore_data.seek_pos = file.file.pos();
+			file_locks.emplace_back(std::move(file_lock));
 
 			file.file.close(); // Actually close it!
 			escaped_real.emplace_back(ensure(idm::get_unlocked<lv2_fs_object, lv2_file>(id)), std::move(escaped));
@@ -1035,6 +1041,8 @@ bool vfs::host::rename(const std::string& from, const std::string& to, const lv2
 		}
 	}
 
+	file_locks.clear();
+
 	fs::g_tls_error = fs_error;
 	return res;
 }
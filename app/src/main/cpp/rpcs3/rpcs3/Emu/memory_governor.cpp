@@ -0,0 +1,287 @@
+#include "stdafx.h"
+#include "memory_governor.hpp"
+
+#include "system_config.h"
+#include "Emu/Cell/timers.hpp"
+#include "Utilities/JIT.h"
+#include "Utilities/mutex.h"
+
+#include "meminfo.h"
+
+#include <algorithm>
+
+LOG_CHANNEL(sys_log, "SYS");
+
+template <>
+void fmt_class_string<rpcs3::memory_governor::pressure_level>::format(std::string& out, u64 arg)
+{
+	format_enum(out, arg, [](rpcs3::memory_governor::pressure_level value)
+	{
+		switch (value)
+		{
+		case rpcs3::memory_governor::pressure_level::none: return "None";
+		case rpcs3::memory_governor::pressure_level::moderate: return "Moderate";
+		case rpcs3::memory_governor::pressure_level::severe: return "Severe";
+		case rpcs3::memory_governor::pressure_level::critical: return "Critical";
+		}
+
+		return unknown;
+	});
+}
+
+namespace rpcs3::memory_governor
+{
+	namespace
+	{
+		struct registered_pool
+		{
+			u32 id;
+			pool_info info;
+			u64 peak_usage = 0;
+			u64 bytes_reclaimed = 0;
+			u32 trim_count = 0;
+		};
+
+		constexpr u64 host_sample_interval_us = 250'000;
+		constexpr u64 trim_cooldown_us = 1'000'000;
+
+		shared_mutex g_mutex;
+		std::vector<registered_pool> g_pools;
+		u32 g_next_pool_id = 1;
+
+		host_memory_status g_host_status{};
+		u64 g_last_host_sample = 0;
+
+		pressure_level g_last_trim_level = pressure_level::none;
+		u64 g_last_trim_time = 0;
+
+		void register_builtin_pools()
+		{
+			// asmjit-backed code/data regions. These are bump allocated and can't be reclaimed.
+			pool_info jit_pool;
+			jit_pool.name = "JIT (asmjit)";
+			jit_pool.priority = pool_priority::jit;
+			jit_pool.get_usage = []()
+			{
+				const u64 code = jit_runtime::peek(true) - jit_runtime::alloc(0, 0, true);
+				const u64 data = jit_runtime::peek(false) - jit_runtime::alloc(0, 0, false);
+				return code + data;
+			};
+
+			g_pools.push_back({ g_next_pool_id++, std::move(jit_pool) });
+		}
+
+		void ensure_initialized()
+		{
+			if (g_next_pool_id == 1)
+			{
+				register_builtin_pools();
+			}
+		}
+
+		pool_priority get_max_trim_priority(pressure_level level)
+		{
+			switch (level)
+			{
+			case pressure_level::moderate:
+				return pool_priority::texture_cache;
+			case pressure_level::severe:
+				return pool_priority::ring_heap;
+			default:
+				return pool_priority::jit;
+			}
+		}
+	}
+
+	f32 host_memory_status::load() const
+	{
+		if (!total_kb || available_kb >= total_kb)
+		{
+			return 0.f;
+		}
+
+		return (total_kb - available_kb) * 100.f / total_kb;
+	}
+
+	u32 register_pool(pool_info info)
+	{
+		std::lock_guard lock(g_mutex);
+		ensure_initialized();
+
+		const u32 id = g_next_pool_id++;
+		g_pools.push_back({ id, std::move(info) });
+		return id;
+	}
+
+	void unregister_pool(u32 id)
+	{
+		std::lock_guard lock(g_mutex);
+
+		g_pools.erase(std::remove_if(g_pools.begin(), g_pools.end(), FN(x.id == id)), g_pools.end());
+	}
+
+	host_memory_status get_host_memory_status()
+	{
+		const u64 now = get_system_time();
+
+		{
+			reader_lock lock(g_mutex);
+
+			if (g_last_host_sample && (now - g_last_host_sample) < host_sample_interval_us)
+			{
+				return g_host_status;
+			}
+		}
+
+		host_memory_status status{};
+		status.total_kb = meminfo_sys_mem_total_kb();
+		status.available_kb = meminfo_sys_mem_available_kb();
+		status.psi_some_avg10 = meminfo_psi_memory_avg10(false);
+		status.psi_full_avg10 = meminfo_psi_memory_avg10(true);
+
+		std::lock_guard lock(g_mutex);
+		g_host_status = status;
+		g_last_host_sample = now;
+		return status;
+	}
+
+	pressure_level get_host_pressure()
+	{
+		if (!g_cfg.core.memory_governor)
+		{
+			return pressure_level::none;
+		}
+
+		const auto status = get_host_memory_status();
+		if (!status.total_kb)
+		{
+			return pressure_level::none;
+		}
+
+		const f32 threshold = static_cast<f32>(g_cfg.core.host_memory_pressure_threshold.get());
+		const f32 severe_threshold = threshold + (100.f - threshold) / 2;
+		const f32 load = status.load();
+
+		pressure_level result = pressure_level::none;
+
+		if (load >= severe_threshold)
+		{
+			result = pressure_level::severe;
+		}
+		else if (load >= threshold)
+		{
+			result = pressure_level::moderate;
+		}
+
+		// PSI tells us how much time tasks actually spend stalled on memory, which is a much better
+		// predictor of an imminent low memory kill than the raw usage figure.
+		if (status.psi_full_avg10 >= 10.f || status.available_kb < (status.total_kb / 32))
+		{
+			result = pressure_level::critical;
+		}
+		else if (status.psi_some_avg10 >= 30.f)
+		{
+			result = std::max(result, pressure_level::severe);
+		}
+		else if (status.psi_some_avg10 >= 10.f)
+		{
+			result = std::max(result, pressure_level::moderate);
+		}
+
+		return result;
+	}
+
+	pressure_level update(pressure_level device_pressure)
+	{
+		const auto host_pressure = get_host_pressure();
+		const auto level = std::max(host_pressure, device_pressure);
+
+		if (level == pressure_level::none)
+		{
+			return level;
+		}
+
+		const u64 now = get_system_time();
+
+		std::lock_guard lock(g_mutex);
+		ensure_initialized();
+
+		// Repeated trimming at the same level within a short window only burns CPU, the pools need time to drain
+		if (level <= g_last_trim_level && (now - g_last_trim_time) < trim_cooldown_us)
+		{
+			return level;
+		}
+
+		g_last_trim_level = level;
+		g_last_trim_time = now;
+
+		std::stable_sort(g_pools.begin(), g_pools.end(), FN(x.info.priority < y.info.priority));
+
+		const auto max_priority = get_max_trim_priority(level);
+		u64 total_reclaimed = 0;
+
+		for (auto& pool : g_pools)
+		{
+			if (pool.info.priority > max_priority)
+			{
+				break;
+			}
+
+			if (!pool.info.trim)
+			{
+				continue;
+			}
+
+			const u64 reclaimed = pool.info.trim(level);
+			pool.bytes_reclaimed += reclaimed;
+			pool.trim_count++;
+			total_reclaimed += reclaimed;
+		}
+
+		if (host_pressure >= pressure_level::moderate)
+		{
+			sys_log.warning("Host memory pressure is %s (load=%d%%, PSI some=%.2f). Reclaimed %llu KiB from host caches.",
+				host_pressure, static_cast<int>(g_host_status.load()), g_host_status.psi_some_avg10, total_reclaimed / 1024);
+		}
+
+		return level;
+	}
+
+	std::vector<pool_stats> get_pool_stats()
+	{
+		std::lock_guard lock(g_mutex);
+		ensure_initialized();
+
+		std::vector<pool_stats> result;
+		result.reserve(g_pools.size());
+
+		for (auto& pool : g_pools)
+		{
+			const u64 usage = pool.info.get_usage ? pool.info.get_usage() : 0;
+			pool.peak_usage = std::max(pool.peak_usage, usage);
+
+			result.push_back({ pool.info.name, pool.info.priority, usage, pool.peak_usage, pool.bytes_reclaimed, pool.trim_count });
+		}
+
+		return result;
+	}
+
+	std::string format_pool_stats()
+	{
+		const auto status = get_host_memory_status();
+		std::string result = fmt::format("Host memory: %d%% (%lluM free)", static_cast<int>(status.load()), status.available_kb / 1024);
+
+		if (status.psi_some_avg10 >= 0.f)
+		{
+			fmt::append(result, ", PSI some %.2f full %.2f", status.psi_some_avg10, status.psi_full_avg10);
+		}
+
+		for (const auto& pool : get_pool_stats())
+		{
+			fmt::append(result, "\n%-24s %6lluM (peak %lluM, trimmed %lluM in %u passes)",
+				pool.name, pool.usage / 0x100000, pool.peak_usage / 0x100000, pool.bytes_reclaimed / 0x100000, pool.trim_count);
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// System-wide memory pressure governor.
+// Folds the host's memory state (/proc/meminfo, PSI) into the renderer's own view of video memory
+// and drives prioritized trimming of registered memory pools. On unified memory devices VRAM and host
+// caches compete for the same physical pages, so neither side can make a good decision alone.
+namespace rpcs3::memory_governor
+{
+	enum class pressure_level : u8
+	{
+		none,
+		moderate,
+		severe,
+		critical
+	};
+
+	// Pools are trimmed in ascending priority order. Cheaper-to-rebuild data goes first.
+	enum class pool_priority : u8
+	{
+		host_cache,      // Disposable host-side caches (decoded media, staging copies)
+		texture_cache,
+		surface_cache,
+		ring_heap,
+		jit,             // Generated code. Usually report-only.
+	};
+
+	struct pool_info
+	{
+		std::string name;
+		pool_priority priority = pool_priority::host_cache;
+
+		// Bytes currently held by the pool
+		std::function<u64()> get_usage;
+
+		// Releases memory according to the pressure level, returns an estimate of the bytes reclaimed.
+		// Optional; pools without a trim callback only report their usage.
+		// Called with the governor lock held, must not (un)register pools.
+		std::function<u64(pressure_level)> trim;
+	};
+
+	struct pool_stats
+	{
+		std::string name;
+		pool_priority priority;
+		u64 usage;
+		u64 peak_usage;
+		u64 bytes_reclaimed;
+		u32 trim_count;
+	};
+
+	struct host_memory_status
+	{
+		u64 total_kb = 0;
+		u64 available_kb = 0;
+		f32 psi_some_avg10 = -1.f; // Negative if PSI is unavailable
+		f32 psi_full_avg10 = -1.f;
+
+		// Percentage of host memory in use
+		f32 load() const;
+	};
+
+	u32 register_pool(pool_info info);
+	void unregister_pool(u32 id);
+
+	// Sampled at most every few hundred milliseconds, safe to call often
+	host_memory_status get_host_memory_status();
+	pressure_level get_host_pressure();
+
+	// Called periodically by the renderer with its own view of video memory.
+	// Trims host-side pools if required and returns the effective pressure the caller should act on.
+	pressure_level update(pressure_level device_pressure);
+
+	std::vector<pool_stats> get_pool_stats();
+	std::string format_pool_stats();
+}
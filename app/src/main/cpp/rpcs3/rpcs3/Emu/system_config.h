@@ -111,6 +111,11 @@ struct cfg_root : cfg::node
 		cfg::uint64 perf_report_threshold{this, "Performance Report Threshold", 500, true}; // In µs, 0.5ms = default, 0 = everything
 		cfg::_bool perf_report{this, "Enable Performance Report", false, true}; // Show certain perf-related logs
 		cfg::_bool external_debugger{this, "Assume External Debugger"};
+		cfg::_bool memory_governor{ this, "Memory Pressure Governor", true, true }; // Trim caches when the host runs low on memory
+		cfg::uint<50, 99> host_memory_pressure_threshold{ this, "Host Memory Pressure Threshold", 85, true }; // Percentage of host memory in use before caches are trimmed
+		cfg::uint<0, 16> vdec_threads{ this, "Video Decoder Threads", 0, true }; // 0 = Auto. Applied when a decoder is opened.
+		cfg::_bool vdec_frame_threading{ this, "Video Decoder Frame Threading", false, true }; // Faster, but pictures are returned a few AUs later
+		cfg::_bool vdec_hwaccel{ this, "Video Decoder Hardware Acceleration", false, true }; // Falls back to software if no device is available
 	} core{ this };
 
 	struct node_vfs : cfg::node
@@ -165,11 +170,14 @@ struct cfg_root : cfg::node
 		cfg::_bool frame_skip_enabled{ this, "Enable Frame Skip", false, true };
 		cfg::_bool force_cpu_blit_processing{ this, "Force CPU Blit", false, true }; // Debugging option
 		cfg::_bool disable_on_disk_shader_cache{ this, "Disable On-Disk Shader Cache", false };
+		cfg::_bool texture_disk_cache{ this, "Texture Disk Cache", false };
+		cfg::uint<64, 8192> texture_disk_cache_size{ this, "Texture Disk Cache Size", 1024 }; // In MiB
 		cfg::_bool disable_vulkan_mem_allocator{ this, "Disable Vulkan Memory Allocator", false };
 		cfg::_bool full_rgb_range_output{ this, "Use full RGB output range", true, true }; // Video out dynamic range
 		cfg::_bool strict_texture_flushing{ this, "Strict Texture Flushing", false };
 		cfg::_bool multithreaded_rsx{ this, "Multithreaded RSX", false };
 		cfg::_bool relaxed_zcull_sync{ this, "Relaxed ZCULL Sync", false };
+		cfg::_bool predictive_zcull_reports{ this, "Predictive ZCULL Reports", false };
 		cfg::_bool force_hw_MSAA_resolve{ this, "Force Hardware MSAA Resolve", false, true };
 		cfg::_enum<stereo_render_mode_options> stereo_render_mode{ this, "3D Display Mode", stereo_render_mode_options::disabled };
 		cfg::_bool debug_program_analyser{ this, "Debug Program Analyser", false };
@@ -239,6 +247,7 @@ struct cfg_root : cfg::node
                 cfg::_bool disable_texture_compression_bc{this, "disable_texture_compression_bc"};
                 cfg::_bool disable_multidraw{this,
                                                                 "disable_multidraw"};
+                cfg::_bool disable_memory_budget{this, "disable_memory_budget"};
 
                 cfg::_bool disable_depth_clamp{this, "disable_depth_clamp"};
                 cfg::_bool disable_shader_clip_distance{this, "disable_shader_clip_distance"};
@@ -307,9 +316,12 @@ struct cfg_root : cfg::node
 		cfg::_int<0, 200> volume{ this, "Master Volume", 100, true };
 		cfg::_bool enable_buffering{ this, "Enable Buffering", true, true };
 		cfg::_int <4, 250> desired_buffer_duration{ this, "Desired Audio Buffer Duration", 100, true };
+		cfg::_bool adaptive_buffering{ this, "Adaptive Buffering", false, true };
 		cfg::_bool enable_time_stretching{ this, "Enable Time Stretching", false, true };
 		cfg::_bool disable_sampling_skip{ this, "Disable Sampling Skip", false, true };
 		cfg::_int<0, 100> time_stretching_threshold{ this, "Time Stretching Threshold", 75, true };
+		cfg::_bool atracx_pcm_cache{ this, "ATRAC3plus Decoding Cache", false };
+		cfg::uint<4, 512> atracx_pcm_cache_size{ this, "ATRAC3plus Decoding Cache Size", 64, true }; // In MiB
 		cfg::_enum<microphone_handler> microphone_type{ this, "Microphone Type", microphone_handler::null };
 		cfg::string microphone_devices{ this, "Microphone Devices", "@@@@@@@@@@@@" };
 		cfg::_enum<music_handler> music{ this, "Music Handler", music_handler::qt };
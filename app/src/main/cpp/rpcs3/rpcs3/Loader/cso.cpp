@@ -0,0 +1,336 @@
+
+#include "cso.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <zlib.h>
+
+#include "util/logs.hpp"
+
+LOG_CHANNEL(iso_fs_log);
+
+static uint64_t pread_all(int fd, uint8_t* buffer, uint64_t size, uint64_t offset){
+    uint64_t done=0;
+    while(done<size){
+        const ssize_t n=::pread(fd, buffer+done, size-done, offset+done);
+        if(n<0&&errno==EINTR)
+            continue;
+        if(n<=0)
+            break;
+        done+=n;
+    }
+    return done;
+}
+
+static bool pwrite_all(int fd, const uint8_t* buffer, uint64_t size, uint64_t offset){
+    uint64_t done=0;
+    while(done<size){
+        const ssize_t n=::pwrite(fd, buffer+done, size-done, offset+done);
+        if(n<0&&errno==EINTR)
+            continue;
+        if(n<=0)
+            return false;
+        done+=n;
+    }
+    return true;
+}
+
+// zlib streams are kept per thread, setting one up costs more than inflating a small block
+static bool inflate_block(const uint8_t* in, uint64_t in_size, uint8_t* out, uint64_t out_size){
+    struct inflater_t {
+        z_stream stream{};
+        const bool ok=inflateInit2(&stream, -15)==Z_OK;
+        ~inflater_t(){if(ok) inflateEnd(&stream);}
+    };
+    thread_local inflater_t z;
+
+    if(!z.ok||inflateReset(&z.stream)!=Z_OK)
+        return false;
+
+    z.stream.next_in=const_cast<Bytef*>(in);
+    z.stream.avail_in=in_size;
+    z.stream.next_out=out;
+    z.stream.avail_out=out_size;
+
+    // Blocks may be followed by alignment padding, so only the output size is checked
+    const int res=inflate(&z.stream, Z_FINISH);
+    return res!=Z_DATA_ERROR&&res!=Z_MEM_ERROR&&res!=Z_STREAM_ERROR&&z.stream.avail_out==0;
+}
+
+static uint64_t deflate_block(const uint8_t* in, uint64_t in_size, std::vector<uint8_t>& out){
+    struct deflater_t {
+        z_stream stream{};
+        const bool ok=deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY)==Z_OK;
+        ~deflater_t(){if(ok) deflateEnd(&stream);}
+    };
+    thread_local deflater_t z;
+
+    if(!z.ok||deflateReset(&z.stream)!=Z_OK)
+        return 0;
+
+    out.resize(deflateBound(&z.stream, in_size));
+    z.stream.next_in=const_cast<Bytef*>(in);
+    z.stream.avail_in=in_size;
+    z.stream.next_out=out.data();
+    z.stream.avail_out=out.size();
+
+    if(deflate(&z.stream, Z_FINISH)!=Z_STREAM_END)
+        return 0;
+    return z.stream.total_out;
+}
+
+cso_worker_pool::~cso_worker_pool(){
+    {
+        std::lock_guard lock(mutex);
+        stop=true;
+    }
+    work_cv.notify_all();
+    for(auto& thread:threads)
+        thread.join();
+}
+
+void cso_worker_pool::run(uint32_t count, const std::function<void(uint32_t)>& task){
+    auto batch=std::make_shared<batch_t>();
+    batch->task=&task;
+    batch->count=count;
+
+    if(count>1&&thread_count){
+        std::call_once(start_flag, [this](){
+            for(uint32_t i=0;i<thread_count;i++)
+                threads.emplace_back(&cso_worker_pool::work, this);
+        });
+
+        std::lock_guard lock(mutex);
+        batches.push_back(batch);
+        work_cv.notify_all();
+    }
+
+    uint32_t finished=0;
+    for(uint32_t i;(i=batch->next++)<count;finished++)
+        task(i);
+
+    std::unique_lock lock(mutex);
+    batch->done+=finished;
+    if(auto it=std::find(batches.begin(), batches.end(), batch);it!=batches.end())
+        batches.erase(it);
+    done_cv.wait(lock, [&](){return batch->done==count;});
+}
+
+void cso_worker_pool::work(){
+    std::unique_lock lock(mutex);
+    for(;;){
+        work_cv.wait(lock, [this](){return stop||!batches.empty();});
+        if(stop)
+            return;
+
+        // Holding a reference keeps the batch alive even if its owner already returned
+        std::shared_ptr<batch_t> batch=batches.front();
+        if(batch->next>=batch->count){
+            batches.pop_front();
+            continue;
+        }
+
+        lock.unlock();
+        uint32_t finished=0;
+        for(uint32_t i;(i=batch->next++)<batch->count;finished++)
+            (*batch->task)(i);
+        lock.lock();
+
+        if(finished&&(batch->done+=finished)==batch->count)
+            done_cv.notify_all();
+    }
+}
+
+cso_image::cso_image(int fd)
+    :fd(fd),header{},pool(std::clamp(std::thread::hardware_concurrency()/2, 1u, 4u)){
+}
+
+std::unique_ptr<cso_image> cso_image::open(int fd){
+    cso_header_t header;
+    if(pread_all(fd, reinterpret_cast<uint8_t*>(&header), sizeof(header), 0)!=sizeof(header)||memcmp(header.magic, "CISO", 4)!=0)
+        return nullptr;
+
+    if(header.version>1){
+        iso_fs_log.error("cso_image: unsupported version %u", header.version);
+        return nullptr;
+    }
+
+    if(header.block_size<0x800||header.block_size>0x1000000||(header.block_size&(header.block_size-1))||!header.total_bytes||header.align>31){
+        iso_fs_log.error("cso_image: invalid header (block_size=0x%x, total_bytes=0x%llx, align=%u)", header.block_size, header.total_bytes, header.align);
+        return nullptr;
+    }
+
+    std::unique_ptr<cso_image> image(new cso_image(fd));
+    image->header=header;
+
+    const uint64_t block_count=(header.total_bytes+header.block_size-1)/header.block_size;
+    image->index.resize(block_count+1);
+
+    const uint64_t index_size=image->index.size()*sizeof(uint32_t);
+    if(pread_all(fd, reinterpret_cast<uint8_t*>(image->index.data()), index_size, sizeof(header))!=index_size){
+        iso_fs_log.error("cso_image: truncated index");
+        return nullptr;
+    }
+
+    for(uint64_t i=0;i<block_count;i++){
+        if(image->block_offset(i+1)<image->block_offset(i)){
+            iso_fs_log.error("cso_image: index is not sorted at block %llu", i);
+            return nullptr;
+        }
+    }
+
+    return image;
+}
+
+ssize_t cso_image::read(uint64_t offset, uint8_t* buffer, uint64_t size){
+    if(offset>=header.total_bytes)
+        return 0;
+    size=std::min(size, header.total_bytes-offset);
+    if(!size)
+        return 0;
+
+    const uint64_t block_size=header.block_size;
+    const uint64_t first=offset/block_size;
+    const uint64_t last=(offset+size-1)/block_size;
+
+    // Compressed blocks are stored in order, so the whole range comes off flash in one read
+    const uint64_t src_begin=block_offset(first);
+    std::vector<uint8_t> src(block_offset(last+1)-src_begin);
+    if(pread_all(fd, src.data(), src.size(), src_begin)!=src.size())
+        return -1;
+
+    std::atomic<bool> failed=false;
+
+    pool.run(last-first+1, [&](uint32_t i){
+        const uint64_t block=first+i;
+        const uint64_t block_start=block*block_size;
+        const uint64_t raw_size=std::min(block_size, header.total_bytes-block_start);
+        const uint64_t out_begin=std::max(offset, block_start);
+        const uint64_t out_end=std::min(offset+size, block_start+raw_size);
+        const uint8_t* in=src.data()+(block_offset(block)-src_begin);
+        const uint64_t in_size=block_offset(block+1)-block_offset(block);
+        uint8_t* out=buffer+(out_begin-offset);
+
+        if(is_plain(block)){
+            if(in_size<out_end-block_start){
+                failed=true;
+                return;
+            }
+            memcpy(out, in+(out_begin-block_start), out_end-out_begin);
+            return;
+        }
+
+        if(out_begin==block_start&&out_end==block_start+raw_size){
+            if(!inflate_block(in, in_size, out, raw_size))
+                failed=true;
+            return;
+        }
+
+        thread_local std::vector<uint8_t> partial;
+        partial.resize(raw_size);
+        if(!inflate_block(in, in_size, partial.data(), raw_size)){
+            failed=true;
+            return;
+        }
+        memcpy(out, partial.data()+(out_begin-block_start), out_end-out_begin);
+    });
+
+    if(failed){
+        iso_fs_log.error("cso_image: failed to decompress blocks %llu..%llu", first, last);
+        return -1;
+    }
+    return size;
+}
+
+bool cso_compress(int in_fd, int out_fd, uint32_t block_size, const std::function<bool(uint64_t done, uint64_t total)>& progress){
+    struct stat st;
+    if(fstat(in_fd, &st)!=0||st.st_size<=0)
+        return false;
+
+    if(block_size<0x800||block_size>0x1000000||(block_size&(block_size-1)))
+        return false;
+
+    const uint64_t total=st.st_size;
+    const uint64_t block_count=(total+block_size-1)/block_size;
+
+    std::vector<uint32_t> index(block_count+1);
+    const uint64_t data_start=sizeof(cso_header_t)+index.size()*sizeof(uint32_t);
+
+    // Offsets must fit in 31 bits after shifting, each block can waste up to one alignment unit of padding
+    uint8_t align=0;
+    while(((data_start+total)>>align)+block_count+1>=0x80000000)
+        align++;
+    const uint64_t align_mask=(1ull<<align)-1;
+
+    cso_header_t header{};
+    memcpy(header.magic, "CISO", 4);
+    header.header_size=sizeof(cso_header_t);
+    header.total_bytes=total;
+    header.block_size=block_size;
+    header.version=1;
+    header.align=align;
+
+    constexpr uint32_t batch_blocks=64;
+
+    cso_worker_pool pool(std::clamp(std::thread::hardware_concurrency(), 1u, 8u)-1);
+    std::vector<uint8_t> in(uint64_t(batch_blocks)*block_size);
+    std::vector<std::vector<uint8_t>> compressed(batch_blocks);
+    std::vector<uint64_t> compressed_size(batch_blocks);
+    std::vector<uint8_t> out;
+
+    uint64_t pos=(data_start+align_mask)&~align_mask;
+
+    for(uint64_t first=0;first<block_count;first+=batch_blocks){
+        const uint32_t count=std::min<uint64_t>(batch_blocks, block_count-first);
+        const uint64_t in_offset=first*block_size;
+        const uint64_t in_size=std::min<uint64_t>(uint64_t(count)*block_size, total-in_offset);
+
+        if(pread_all(in_fd, in.data(), in_size, in_offset)!=in_size)
+            return false;
+
+        pool.run(count, [&](uint32_t i){
+            const uint64_t raw_size=std::min<uint64_t>(block_size, in_size-uint64_t(i)*block_size);
+            compressed_size[i]=deflate_block(in.data()+uint64_t(i)*block_size, raw_size, compressed[i]);
+        });
+
+        // Blocks that do not shrink are stored as is
+        out.clear();
+        for(uint32_t i=0;i<count;i++){
+            const uint64_t raw_size=std::min<uint64_t>(block_size, in_size-uint64_t(i)*block_size);
+            const bool plain=!compressed_size[i]||compressed_size[i]>=raw_size;
+
+            index[first+i]=((pos+out.size())>>align)|(plain?0x80000000:0);
+
+            if(plain)
+                out.insert(out.end(), in.data()+uint64_t(i)*block_size, in.data()+uint64_t(i)*block_size+raw_size);
+            else
+                out.insert(out.end(), compressed[i].data(), compressed[i].data()+compressed_size[i]);
+
+            out.resize(((pos+out.size()+align_mask)&~align_mask)-pos);
+        }
+
+        if(!pwrite_all(out_fd, out.data(), out.size(), pos))
+            return false;
+        pos+=out.size();
+
+        if(progress&&!progress(in_offset+in_size, total))
+            return false;
+    }
+
+    index[block_count]=pos>>align;
+
+    if(!pwrite_all(out_fd, reinterpret_cast<const uint8_t*>(&header), sizeof(header), 0)||
+       !pwrite_all(out_fd, reinterpret_cast<const uint8_t*>(index.data()), index.size()*sizeof(uint32_t), sizeof(header)))
+        return false;
+
+    // Drops anything left over if out_fd held a larger file before
+    if(ftruncate(out_fd, pos)!=0)
+        return false;
+
+    iso_fs_log.notice("cso_compress: %llu bytes compressed to %llu", total, pos);
+    return true;
+}
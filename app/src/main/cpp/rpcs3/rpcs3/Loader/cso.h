@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// CISO v1 block compressed disc image. A 24 byte header is followed by an index of block offsets and raw deflate blocks.
+// Index entries hold the file offset of each block shifted right by align, bit 31 marks a block stored uncompressed.
+struct cso_header_t {
+    char magic[4];
+    uint32_t header_size;
+    uint64_t total_bytes;
+    uint32_t block_size;
+    uint8_t version;
+    uint8_t align;
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(cso_header_t)==24, "sizeof(cso_header_t) != 24");
+
+// Runs the blocks of one request on a few host threads, the calling thread takes part as well
+class cso_worker_pool {
+public:
+    explicit cso_worker_pool(uint32_t thread_count):thread_count(thread_count){}
+    ~cso_worker_pool();
+
+    cso_worker_pool(const cso_worker_pool&) = delete;
+
+    // Calls task(i) for every i below count and returns once all calls finished
+    void run(uint32_t count, const std::function<void(uint32_t)>& task);
+
+private:
+    struct batch_t {
+        const std::function<void(uint32_t)>* task;
+        uint32_t count;
+        std::atomic<uint32_t> next{0};
+        uint32_t done=0; // Guarded by mutex
+    };
+
+    void work();
+
+    const uint32_t thread_count;
+    std::once_flag start_flag; // Threads are only started by the first request spanning several blocks
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::deque<std::shared_ptr<batch_t>> batches;
+    bool stop=false;
+};
+
+struct cso_image {
+    // Returns nullptr if fd does not hold a supported CSO image, the descriptor stays owned by the caller
+    static std::unique_ptr<cso_image> open(int fd);
+
+    uint64_t size() const {return header.total_bytes;}
+
+    // Reads decompressed image data, safe to call from several threads.
+    // The compressed range is fetched with a single host read and its blocks are inflated in parallel.
+    ssize_t read(uint64_t offset, uint8_t* buffer, uint64_t size);
+
+private:
+    explicit cso_image(int fd);
+
+    uint64_t block_offset(uint64_t block) const {return uint64_t(index[block]&0x7fffffff)<<header.align;}
+    bool is_plain(uint64_t block) const {return index[block]&0x80000000;}
+
+    int fd;
+    cso_header_t header;
+    std::vector<uint32_t> index; // One entry per block plus the end of the last block
+    cso_worker_pool pool;
+};
+
+// Converts the image in in_fd to a CSO written to out_fd, blocks are compressed in parallel.
+// progress is called after every batch of blocks, returning false from it cancels the conversion.
+bool cso_compress(int in_fd, int out_fd, uint32_t block_size, const std::function<bool(uint64_t done, uint64_t total)>& progress);
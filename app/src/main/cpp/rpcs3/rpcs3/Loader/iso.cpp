@@ -1,5 +1,10 @@
 
 #include "iso.h"
+#include "cso.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #ifdef __ANDROID__
 #include <android/log.h>
 #define LOG_TAG "iso_fs"
@@ -9,6 +14,7 @@
 std::unique_ptr<iso_fs> iso_fs::from_fd(int fd) {
     std::unique_ptr<iso_fs> _iso_fs=std::make_unique<iso_fs>();
     _iso_fs->fd = fd;
+    _iso_fs->cso = cso_image::open(fd);
     return _iso_fs;
 }
 
@@ -20,10 +26,8 @@ bool iso_fs::load(){
     std::optional<VolumeDescriptor> supplementary_vd;
 
     for(;;){
-        lseek(fd, pos, SEEK_SET);
-
         VolumeDescriptor vd;
-        if(::read(fd, &vd, sizeof(vd))!=sizeof(vd)){
+        if(pread_full(pos, reinterpret_cast<uint8_t*>(&vd), sizeof(vd))!=sizeof(vd)){
             return false;
         }
 
@@ -65,40 +69,69 @@ bool iso_fs::load(){
         return false;
 }
 
-static std::string path_fix(const std::string& path){
-    std::string path_fix=path;
-    if(path_fix.back()=='/')
-        path_fix.pop_back();
-    return path_fix;
+size_t iso_fs::path_hash::operator()(std::string_view path) const{
+    uint64_t hash=0xcbf29ce484222325ull;
+    for(const char c:path){
+        hash^=static_cast<uint8_t>(c>='a'&&c<='z'?c-0x20:c);
+        hash*=0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool iso_fs::path_equal::operator()(std::string_view lhs, std::string_view rhs) const{
+    if(lhs.size()!=rhs.size())
+        return false;
+    for(size_t i=0;i<lhs.size();i++){
+        const char l=lhs[i]>='a'&&lhs[i]<='z'?lhs[i]-0x20:lhs[i];
+        const char r=rhs[i]>='a'&&rhs[i]<='z'?rhs[i]-0x20:rhs[i];
+        if(l!=r)
+            return false;
+    }
+    return true;
 }
 
-bool iso_fs::exists(const std::string& path){
-    return files.find(path_fix(path))!=files.end();
+const iso_fs::entry_t* iso_fs::get_entry(std::string_view path) const{
+    if(path.size()>1&&path.back()=='/')
+        path.remove_suffix(1);
+    if(auto it=index.find(path);it!=index.end())
+        return &entries[it->second];
+    return nullptr;
 }
 
-std::vector<uint8_t> iso_fs::get_data_tiny(const std::string& path){
-    auto it = files.find(path);
-    if (it != files.end()) {
-        const entry_t& entry = it->second;
-#if 0
-        if(entry.blocks.size()!=1){
-            //FIXME 应该抛出异常,get_data_tiny应该只用于获取轻量级文件
-            return {};
-        }
-        lseek(fd, entry.blocks[0].offset, SEEK_SET);
-        std::vector<uint8_t> buffer(entry.blocks[0].size);
-#else
-        lseek(fd, entry.offset, SEEK_SET);
-        std::vector<uint8_t> buffer(entry.size);
-#endif
-        ::read(fd, buffer.data(), buffer.size());
+std::vector<uint8_t> iso_fs::get_data_tiny(std::string_view path){
+    if(const entry_t* entry=get_entry(path);entry&&!entry->is_dir){
+        std::vector<uint8_t> buffer(entry->size);
+        buffer.resize(read_entry(*entry, 0, buffer.data(), buffer.size()));
         return buffer;
     }
     return {};
 }
 
-std::vector<iso_fs::entry_t>& iso_fs::list_dir(const std::string& path){
-    return tree[path_fix(path)];
+std::span<const iso_fs::entry_t> iso_fs::list_dir(std::string_view path) const{
+    if(const entry_t* entry=get_entry(path);entry&&entry->is_dir)
+        return std::span<const entry_t>(entries).subspan(entry->first_child, entry->child_count);
+    return {};
+}
+
+uint64_t iso_fs::read_entry(const entry_t& entry, uint64_t pos, uint8_t* buffer, uint64_t size){
+    uint64_t done=0;
+    for(const extent_t& extent:entry.extents){
+        if(done==size)
+            break;
+        if(pos>=extent.size){
+            pos-=extent.size;
+            continue;
+        }
+        const uint64_t n=std::min(size-done, extent.size-pos);
+        const ssize_t nread=read_at(extent.offset+pos, buffer+done, n);
+        if(nread<=0)
+            break;
+        done+=nread;
+        if(static_cast<uint64_t>(nread)<n)
+            break;
+        pos=0;
+    }
+    return done;
 }
 
 iso_fs::~iso_fs()
@@ -106,38 +139,134 @@ iso_fs::~iso_fs()
     close(fd);
 }
 
+ssize_t iso_fs::pread_full(uint64_t offset, uint8_t* buffer, uint64_t size){
+    if(cso)
+        return std::max<ssize_t>(cso->read(offset, buffer, size), 0);
+
+    uint64_t done=0;
+    while(done<size){
+        const ssize_t n=::pread(fd, buffer+done, size-done, offset+done);
+        if(n<0&&errno==EINTR)
+            continue;
+        if(n<=0)
+            break;
+        done+=n;
+    }
+    return done;
+}
+
+ssize_t iso_fs::read_at(uint64_t offset, uint8_t* buffer, uint64_t size){
+    if(size>=DIRECT_READ_SIZE){
+        // Streaming reads gain nothing from the cache and would only evict the small hot blocks
+        {
+            std::lock_guard lock(cache_mutex);
+            next_block=(offset+size)/CACHE_BLOCK_SIZE;
+            read_ahead=CACHE_MAX_READ_AHEAD;
+        }
+        return pread_full(offset, buffer, size);
+    }
+
+    uint64_t done=0;
+    while(done<size){
+        const uint64_t pos=offset+done;
+        const uint64_t index=pos/CACHE_BLOCK_SIZE;
+        const uint64_t in_block=pos%CACHE_BLOCK_SIZE;
+
+        uint64_t blocks_to_read=0;
+        {
+            std::lock_guard lock(cache_mutex);
+
+            const bool sequential=index==next_block;
+            next_block=index+1;
+
+            if(auto it=cache.find(index);it!=cache.end()){
+                cache_lru.splice(cache_lru.begin(), cache_lru, it->second.lru);
+                if(in_block>=it->second.size)
+                    break;
+                const uint64_t n=std::min(size-done, it->second.size-in_block);
+                memcpy(buffer+done, it->second.data.get()+in_block, n);
+                done+=n;
+                continue;
+            }
+
+            read_ahead=sequential?std::min(read_ahead*2, CACHE_MAX_READ_AHEAD):1;
+
+            // Extend the host read over the following uncached blocks
+            blocks_to_read=1;
+            while(blocks_to_read<read_ahead&&!cache.count(index+blocks_to_read))
+                blocks_to_read++;
+        }
+
+        // The image is read without holding the lock, racing misses of the same block just insert once
+        std::unique_ptr<uint8_t[]> data(new uint8_t[blocks_to_read*CACHE_BLOCK_SIZE]);
+        const uint64_t nread=pread_full(index*CACHE_BLOCK_SIZE, data.get(), blocks_to_read*CACHE_BLOCK_SIZE);
+
+        if(in_block>=nread)
+            break;
+
+        const uint64_t n=std::min(size-done, nread-in_block);
+        memcpy(buffer+done, data.get()+in_block, n);
+        done+=n;
+
+        std::lock_guard lock(cache_mutex);
+
+        for(uint64_t i=0;i<blocks_to_read&&i*CACHE_BLOCK_SIZE<nread;i++){
+            const uint64_t block_size=std::min(CACHE_BLOCK_SIZE, nread-i*CACHE_BLOCK_SIZE);
+            auto [it,inserted]=cache.try_emplace(index+i);
+            if(!inserted)
+                continue;
+            it->second.data.reset(new uint8_t[block_size]);
+            memcpy(it->second.data.get(), data.get()+i*CACHE_BLOCK_SIZE, block_size);
+            it->second.size=block_size;
+            cache_lru.push_front(index+i);
+            it->second.lru=cache_lru.begin();
+        }
+
+        while(cache.size()>CACHE_MAX_BLOCKS){
+            cache.erase(cache_lru.back());
+            cache_lru.pop_back();
+        }
+    }
+    return done;
+}
+
 template<const int VOLUME_TYPE>
 void iso_fs::parse(VolumeDescriptor& vd){
+    entries.clear();
+    index.clear();
+
     //add root dir
-    {
-        const std::string root{ROOT};
-        files[root]={
-            .path=root,
-            .offset=vd.root_directory_record.extent_location.ne()*2048,
+    entries.push_back(entry_t{
+        .path=std::string{ROOT},
+        .extents={{
+            .offset=vd.root_directory_record.extent_location.ne()*2048ull,
             .size=vd.root_directory_record.data_length.ne(),
-            .time=0,
-            .is_dir=true
-        };
-        tree[root]=std::vector<entry_t>();
-    }
-    read_dir<VOLUME_TYPE>(vd.root_directory_record, std::string{ROOT});
+        }},
+        .size=vd.root_directory_record.data_length.ne(),
+        .time=0,
+        .is_dir=true,
+        .first_child=0,
+        .child_count=0,
+    });
+    read_dir<VOLUME_TYPE>(0);
+
+    // Keys view the path strings, so the index can only be built once entries stops growing
+    index.reserve(entries.size());
+    for(uint32_t i=0;i<entries.size();i++)
+        index.emplace(entries[i].path, i);
 }
 
 template<const int VOLUME_TYPE>
-void iso_fs::read_dir(RootDirectoryRecord& dir_record, std::string path) {
-    if(dir_record.extended_attribute_length!=0){
-        //return;
-    }
-    std::vector<uint8_t> buffer(dir_record.data_length.ne());
-    lseek(fd, dir_record.extent_location.ne()*2048, SEEK_SET);
+void iso_fs::read_dir(uint32_t dir_index) {
+    const std::string path=entries[dir_index].path;
+    const extent_t dir_extent=entries[dir_index].extents[0];
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wsign-compare"
+    std::vector<uint8_t> buffer(dir_extent.size);
 
-    if(::read(fd, buffer.data(), buffer.size())!=buffer.size())
+    if(pread_full(dir_extent.offset, buffer.data(), buffer.size())!=static_cast<ssize_t>(buffer.size()))
         return;
 
-#pragma clang diagnostic pop
+    const uint32_t first_child=entries.size();
 
     for(size_t offset=0;;){
         if(offset>=buffer.size())
@@ -148,9 +277,13 @@ void iso_fs::read_dir(RootDirectoryRecord& dir_record, std::string path) {
             offset+=2048;
             continue;
         }
+        if(offset+length>buffer.size())
+            break;
         RootDirectoryRecord record;
         memcpy(&record, buffer.data()+offset, sizeof(record));
-        if((record.file_identifier_length&1)==1){
+
+        // Skip the "." and ".." records
+        if(record.file_identifier_length==1&&buffer[offset+sizeof(RootDirectoryRecord)]<=1){
             offset+=length;
             continue;
         }
@@ -188,63 +321,15 @@ void iso_fs::read_dir(RootDirectoryRecord& dir_record, std::string path) {
             file_identifier=read_file_identifier_unicode();
         }
 
-#ifdef __ANDROID__
-        //LOGW("%s", file_identifier.c_str());
-#endif
-        //if(path)
-        //    file_identifier=path.value()+"/"+file_identifier;
-
-
         if(path==ROOT)
             file_identifier = path + file_identifier;
         else
             file_identifier = path + "/" + file_identifier;
 
-
-
         if(!(record.file_flags&0x2)) {
             file_identifier = file_identifier.substr(0, file_identifier.find(';'));
         }
 
-#if 0
-        if(auto it=files.find(file_identifier);it!=files.end()){
-            it->second.blocks.push_back({
-                .offset=record.extent_location.ne()*2048,
-                .size=record.data_length.ne(),
-                .entry_offset=it->second.blocks.back().entry_offset+it->second.blocks.back().size,
-                });
-
-        }
-        else{
-            files[file_identifier]=entry_t{
-                    .path=file_identifier,
-                    .blocks={{
-                        .offset=record.extent_location.ne()*2048ull,
-                        .size=record.data_length.ne(),
-                        .entry_offset=0,
-                        }},
-                    .is_dir=!!(record.file_flags&0x2)
-            };
-        }
-
-        //
-
-        if(auto it=tree.find(path.value());it==tree.end()){
-            tree[path.value()]=std::vector<entry_t>();
-        }
-
-        auto& dir_entries = tree[path.value()];
-
-        if(auto it = std::find_if(dir_entries.begin(), dir_entries.end(), [&](const entry_t& entry) {
-            return entry.path == file_identifier;});it != dir_entries.end())
-        {
-            *it = files[file_identifier];
-        }
-        else {
-            dir_entries.push_back(files[file_identifier]);
-        }
-#else
-
         auto recording_date_to_unix_time=[](const uint8_t recording_date[7])->time_t{
             struct tm tm_time = {};
 
@@ -259,34 +344,37 @@ void iso_fs::read_dir(RootDirectoryRecord& dir_record, std::string path) {
             return unix_time;
         };
 
-        if(auto it=files.find(file_identifier);it!=files.end()){
-            it->second.size+=record.data_length.ne();
+        const extent_t extent{
+            .offset=record.extent_location.ne()*2048ull,
+            .size=record.data_length.ne(),
+        };
+
+        // Every record of a multi-extent file but the last has flag 0x80 set, and they follow each other
+        if(entries.size()>first_child&&!(record.file_flags&0x2)&&entries.back().path==file_identifier){
+            entries.back().extents.push_back(extent);
+            entries.back().size+=extent.size;
         }
         else{
-            files[file_identifier]=entry_t{
-                .path=file_identifier,
-                .offset=record.extent_location.ne()*2048ull,
-                .size=record.data_length.ne(),
+            entries.push_back(entry_t{
+                .path=std::move(file_identifier),
+                .extents={extent},
+                .size=extent.size,
                 .time=recording_date_to_unix_time(record.recording_date),
-                .is_dir=!!(record.file_flags&0x2)
-            };
+                .is_dir=!!(record.file_flags&0x2),
+                .first_child=0,
+                .child_count=0,
+            });
         }
+        offset+=length;
+    }
 
-        auto& dir_entries = tree[path];
-        if(auto it = std::find_if(dir_entries.begin(), dir_entries.end(), [&](const entry_t& entry) {
-            return entry.path == file_identifier;
-        });it  != dir_entries.end()){
-            *it = files[file_identifier];
-        }
-        else {
-            dir_entries.push_back(files[file_identifier]);
-        }
+    const uint32_t child_count=entries.size()-first_child;
+    entries[dir_index].first_child=first_child;
+    entries[dir_index].child_count=child_count;
 
-#endif
-        if(record.file_flags&0x2){
-            tree[file_identifier]=std::vector<entry_t>();
-            read_dir<VOLUME_TYPE>(record, file_identifier);
-        }
-        offset+=length;
+    // Recursing only after the whole directory was listed keeps its children contiguous
+    for(uint32_t i=first_child;i<first_child+child_count;i++){
+        if(entries[i].is_dir)
+            read_dir<VOLUME_TYPE>(i);
     }
-}
\ No newline at end of file
+}
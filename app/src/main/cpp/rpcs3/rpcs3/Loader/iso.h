@@ -5,8 +5,13 @@
 #include <bit>
 #include <fcntl.h>
 #include <unistd.h>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <cassert>
@@ -17,6 +22,8 @@
 
 LOG_CHANNEL(iso_fs_log);
 
+struct cso_image;
+
 template<typename T>
 struct le_be_t {
     T le;
@@ -91,6 +98,8 @@ struct VolumeDescriptor {
 
 static_assert(sizeof(VolumeDescriptor)==2048, "sizeof(VolumeDescriptor) != 2048");
 
+#pragma pack(pop)
+
 struct iso_fs{
     static constexpr std::string_view ROOT=":";
     static std::unique_ptr<iso_fs> from_fd(int fd);
@@ -103,81 +112,78 @@ struct iso_fs{
 
     bool load();
 
-    bool exists(const std::string& path);
+    bool exists(std::string_view path) const {return get_entry(path)!=nullptr;}
 
-    std::vector<uint8_t> get_data_tiny(const std::string& path);
+    std::vector<uint8_t> get_data_tiny(std::string_view path);
 
-#if 0
-    struct block_t {
+    struct extent_t {
         uint64_t offset;
         uint64_t size;
-
-        uint64_t entry_offset;
     };
 
     struct entry_t {
         std::string path;
-        std::vector<block_t> blocks;
-        bool  is_dir;
-
-        uint64_t size(){return std::accumulate(blocks.begin(),blocks.end(),0ull,[](uint64_t sum,const block_t& b){return sum+b.size;});}
-    };
-#else
-
-    struct entry_t {
-        std::string path;
-        uint64_t offset;
+        std::vector<extent_t> extents; // Files of 4 GiB and more are split over several directory records
         uint64_t size;
         time_t time;
         bool  is_dir;
+        uint32_t first_child; // Children of a directory are stored next to each other
+        uint32_t child_count;
     };
-#endif
-    entry_t get_entry(const std::string& path){
-        if(files.find(path)==files.end()) {
-            iso_fs_log.warning("iso_fs::get_entry(%s) not found",path);
-            return {};
-        }else {
-            iso_fs_log.warning("iso_fs::get_entry(%s) found",path);
-            return files[path];
-        }
-    }
 
-    std::vector<entry_t>& list_dir(const std::string& path);
-
-    off_t seek(uint64_t offset) const {return lseek(fd, offset, SEEK_SET);}
-    ssize_t read(uint8_t* buffer, uint64_t size){return ::read(fd, buffer, size);}
-
-#if 0
-    void save(int fp,const std::string& path){
-        auto entry=get_entry(path);
-        uint8_t buffer[1024*1024];
-        for(auto& block:entry.blocks){
-            uint64_t  offset=block.offset;
-            uint64_t remaining=block.size;
-            uint64_t buffer_size=std::min(remaining,sizeof(buffer));
-            while(remaining>0){
-                seek(offset);
-                read(buffer,buffer_size);
-                write(fp,buffer,buffer_size);
-                remaining-=buffer_size;
-                offset+=buffer_size;
-                buffer_size=std::min(remaining,sizeof(buffer));
-            }
-        }
-    }
-#endif
+    // Lookup ignores ASCII case and a trailing '/', returns nullptr if the path does not exist
+    const entry_t* get_entry(std::string_view path) const;
+
+    std::span<const entry_t> list_dir(std::string_view path) const;
+
+    // Positional read through the block cache, safe to call from several threads
+    ssize_t read_at(uint64_t offset, uint8_t* buffer, uint64_t size);
+
+    // Reads from a file at pos, following its extents
+    uint64_t read_entry(const entry_t& entry, uint64_t pos, uint8_t* buffer, uint64_t size);
+
 private:
 
     template<const int VOLUME_TYPE>
     void parse(VolumeDescriptor& vd);
 
     template<const int VOLUME_TYPE>
-    void read_dir(RootDirectoryRecord& dir_record,std::string path);
+    void read_dir(uint32_t dir_index);
+
+    // Reads the whole range from the image, retrying short reads
+    ssize_t pread_full(uint64_t offset, uint8_t* buffer, uint64_t size);
+
+    struct path_hash {
+        size_t operator()(std::string_view path) const;
+    };
+
+    struct path_equal {
+        bool operator()(std::string_view lhs, std::string_view rhs) const;
+    };
 
     int fd;
-    std::unordered_map <std::string, entry_t> files;
-    std::unordered_map <std::string, std::vector<entry_t>> tree;
-};
+    std::unique_ptr<cso_image> cso; // Set for block compressed images, the block cache then holds decompressed data
 
-#pragma pack(pop)
+    // Built once by load() and never modified afterwards, entries[0] is the root
+    std::vector<entry_t> entries;
+    std::unordered_map<std::string_view, uint32_t, path_hash, path_equal> index; // Keys point into entries
+
+    // Sector aligned block cache shared by every file opened from the image
+    static constexpr uint64_t CACHE_BLOCK_SIZE=0x10000;
+    static constexpr size_t CACHE_MAX_BLOCKS=256;
+    static constexpr uint64_t CACHE_MAX_READ_AHEAD=8; // In blocks, reached by doubling on sequential misses
+    static constexpr uint64_t DIRECT_READ_SIZE=0x40000; // Larger reads bypass the cache
+
+    struct cache_block_t {
+        std::unique_ptr<uint8_t[]> data;
+        uint64_t size;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    std::mutex cache_mutex;
+    std::unordered_map<uint64_t, cache_block_t> cache;
+    std::list<uint64_t> cache_lru; // Most recently used first
+    uint64_t next_block=UINT64_MAX; // Block that would continue the last access
+    uint64_t read_ahead=1;
+};
 
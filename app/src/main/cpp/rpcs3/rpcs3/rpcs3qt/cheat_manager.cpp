@@ -360,7 +360,7 @@ T cheat_engine::get_value(const u32 offset, bool& success)
 		return 0;
 	}
 
-	return cpu_thread::suspend_all(nullptr, {}, [&]() -> T
+	return cpu_thread::suspend_range(offset, sizeof(T), [&]() -> T
 	{
 		if (!vm::check_addr<sizeof(T)>(offset))
 		{
@@ -384,7 +384,7 @@ bool cheat_engine::set_value(const u32 offset, const T value)
 		return false;
 	}
 
-	return cpu_thread::suspend_all(nullptr, {}, [&]
+	return cpu_thread::suspend_range(offset, sizeof(T), [&]
 	{
 		if (!vm::check_addr<sizeof(T)>(offset))
 		{
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <vector>
+
+namespace utils
+{
+	// Hierarchical timer wheel keyed by absolute deadlines (not thread-safe).
+	// Each level has 64 slots spanning one slot of the level above, a deadline is stored at the level of the highest bit
+	// in which it differs from the current time. Insertion and removal touch a single slot, expiration only visits slots
+	// which have been passed since the previous call and moves entries of the last visited slot down one or more levels.
+	template <typename T>
+	class timer_wheel
+	{
+		static constexpr u32 level_bits = 6;
+		static constexpr u32 level_slots = 1u << level_bits;
+		static constexpr u32 level_count = 6; // Deadlines up to 2^36 time units away, further ones are kept in m_overflow
+
+		struct entry_t
+		{
+			u64 deadline;
+			T value;
+		};
+
+		std::array<std::array<std::vector<entry_t>, level_slots>, level_count> m_slots{};
+		std::array<u64, level_count> m_used{}; // Bitmaps of non-empty slots
+		std::vector<entry_t> m_overflow;
+		std::vector<entry_t> m_due; // Inserted with a deadline which has already passed
+		std::vector<entry_t> m_expired;
+		std::vector<entry_t> m_pending;
+		u64 m_now = 0;
+		usz m_size = 0;
+
+		std::vector<entry_t>& locate(u64 deadline, u32& level, u32& slot)
+		{
+			if (deadline <= m_now)
+			{
+				level = umax;
+				return m_due;
+			}
+
+			level = (63 - std::countl_zero(deadline ^ m_now)) / level_bits;
+
+			if (level >= level_count)
+			{
+				level = umax;
+				return m_overflow;
+			}
+
+			slot = (deadline >> (level * level_bits)) % level_slots;
+			return m_slots[level][slot];
+		}
+
+		void place(entry_t&& entry)
+		{
+			u32 level = 0, slot = 0;
+			locate(entry.deadline, level, slot).emplace_back(std::move(entry));
+
+			if (level != umax)
+			{
+				m_used[level] |= u64{1} << slot;
+			}
+		}
+
+		void take(std::vector<entry_t>& list, u64 now)
+		{
+			for (auto& entry : list)
+			{
+				(entry.deadline <= now ? m_expired : m_pending).emplace_back(std::move(entry));
+			}
+
+			list.clear();
+		}
+
+	public:
+		timer_wheel() = default;
+		timer_wheel(const timer_wheel&) = delete;
+		timer_wheel& operator=(const timer_wheel&) = delete;
+
+		usz size() const
+		{
+			return m_size;
+		}
+
+		bool empty() const
+		{
+			return m_size == 0;
+		}
+
+		void insert(u64 deadline, T value)
+		{
+			place(entry_t{deadline, std::move(value)});
+			m_size++;
+		}
+
+		// Remove an entry inserted with the same deadline and value, returns false if it was not found (or already expired)
+		bool erase(u64 deadline, const T& value)
+		{
+			u32 level = 0, slot = 0;
+			auto& list = locate(deadline, level, slot);
+
+			const auto found = std::find_if(list.begin(), list.end(), [&](const entry_t& entry) { return entry.deadline == deadline && entry.value == value; });
+
+			if (found == list.end())
+			{
+				return false;
+			}
+
+			list.erase(found);
+			m_size--;
+
+			if (level != umax && list.empty())
+			{
+				m_used[level] &= ~(u64{1} << slot);
+			}
+
+			return true;
+		}
+
+		// Earliest deadline in the wheel (umax if empty), entries which were already due are reported with the current time
+		u64 next_deadline() const
+		{
+			if (!m_due.empty())
+			{
+				return m_now;
+			}
+
+			const auto min_of = [](const std::vector<entry_t>& list)
+			{
+				u64 result = umax;
+
+				for (const auto& entry : list)
+				{
+					result = std::min(result, entry.deadline);
+				}
+
+				return result;
+			};
+
+			// Every deadline at a level is below the ones at higher levels, and slots are ordered within a level
+			for (u32 level = 0; level < level_count; level++)
+			{
+				if (const u64 used = m_used[level])
+				{
+					return min_of(m_slots[level][std::countr_zero(used)]);
+				}
+			}
+
+			return min_of(m_overflow);
+		}
+
+		// Advance the current time and call func(deadline, value) for every entry with deadline <= now, in deadline order.
+		// Expired entries are removed before the first call, so func may insert new entries (but not call advance).
+		template <typename F>
+		void advance(u64 now, F&& func)
+		{
+			now = std::max(now, m_now);
+
+			m_expired.clear();
+			m_pending.clear();
+			take(m_due, now);
+
+			for (u32 level = 0; now != m_now && level < level_count; level++)
+			{
+				const u32 shift = level * level_bits;
+				const u32 from = (m_now >> shift) % level_slots;
+				const u32 to = (now >> shift) % level_slots;
+				const bool wrapped = (m_now >> shift >> level_bits) != (now >> shift >> level_bits);
+
+				// Slots after the current one up to the new one, all of them if the time moved past the end of this level
+				const u64 passed = wrapped ? u64{umax} : ((u64{2} << to) - 1) & ~((u64{2} << from) - 1);
+
+				for (u64 used = m_used[level] & passed; used; used &= used - 1)
+				{
+					take(m_slots[level][std::countr_zero(used)], now);
+				}
+
+				m_used[level] &= ~passed;
+
+				if (!wrapped)
+				{
+					// Higher levels did not move
+					break;
+				}
+
+				if (level == level_count - 1)
+				{
+					take(m_overflow, now);
+				}
+			}
+
+			m_now = now;
+			m_size -= m_expired.size();
+
+			for (auto& entry : m_pending)
+			{
+				place(std::move(entry));
+			}
+
+			std::stable_sort(m_expired.begin(), m_expired.end(), [](const entry_t& a, const entry_t& b) { return a.deadline < b.deadline; });
+
+			for (auto& entry : m_expired)
+			{
+				func(entry.deadline, entry.value);
+			}
+		}
+
+		// Drop every entry and restart the time at 0 (the time source may start over, e.g. on a new emulation session)
+		void clear()
+		{
+			for (u32 level = 0; level < level_count; level++)
+			{
+				for (u64 used = m_used[level]; used; used &= used - 1)
+				{
+					m_slots[level][std::countr_zero(used)].clear();
+				}
+
+				m_used[level] = 0;
+			}
+
+			m_overflow.clear();
+			m_due.clear();
+			m_expired.clear();
+			m_pending.clear();
+			m_now = 0;
+			m_size = 0;
+		}
+	};
+}
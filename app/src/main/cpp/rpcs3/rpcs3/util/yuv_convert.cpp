@@ -0,0 +1,414 @@
+#include "util/yuv_convert.hpp"
+#include "util/simd.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace utils
+{
+	namespace
+	{
+		// Fixed point YUV -> RGB coefficients, scaled by 64. The luma factor has one more bit of precision.
+		struct yuv_coefficients
+		{
+			u8 y_offset;
+			u16 y_mul;
+			u16 rv, gu, gv, bu;
+		};
+
+		constexpr yuv_coefficients get_yuv_coefficients(color_matrix matrix, bool full_range)
+		{
+			const bool bt709 = matrix == color_matrix::bt709;
+
+			if (full_range)
+			{
+				return bt709 ? yuv_coefficients{ 0, 128, 101, 12, 30, 119 } : yuv_coefficients{ 0, 128, 90, 22, 46, 113 };
+			}
+
+			return bt709 ? yuv_coefficients{ 16, 149, 115, 14, 34, 135 } : yuv_coefficients{ 16, 149, 102, 25, 52, 129 };
+		}
+
+		// Converts 16 pixels, u and v already hold one chroma sample per pixel
+		inline void convert_yuv_16(const yuv_coefficients& c, const v128& y, const v128& u, const v128& v, v128& r, v128& g, v128& b)
+		{
+			const v128 zero{};
+			const v128 y_bias = gv_bcst16(static_cast<u16>(c.y_offset * c.y_mul / 2 - 32));
+			v128 rgb[3][2];
+
+			for (u32 half = 0; half < 2; half++)
+			{
+				const v128 y16 = half ? gv_unpackhi8(y, zero) : gv_unpacklo8(y, zero);
+				const v128 u16 = gv_sub16(half ? gv_unpackhi8(u, zero) : gv_unpacklo8(u, zero), gv_bcst16(128));
+				const v128 v16 = gv_sub16(half ? gv_unpackhi8(v, zero) : gv_unpacklo8(v, zero), gv_bcst16(128));
+
+				// 255 * 149 only fits in u16, the offset is removed after the shift (16 * 149 is even, so this is exact)
+				const v128 yv = gv_sub16(gv_shr16(gv_mul16(y16, gv_bcst16(c.y_mul)), 1), y_bias);
+
+				rgb[0][half] = gv_sar16(gv_adds_s16(yv, gv_mul16(v16, gv_bcst16(c.rv))), 6);
+				rgb[1][half] = gv_sar16(gv_subs_s16(gv_subs_s16(yv, gv_mul16(u16, gv_bcst16(c.gu))), gv_mul16(v16, gv_bcst16(c.gv))), 6);
+				rgb[2][half] = gv_sar16(gv_adds_s16(yv, gv_mul16(u16, gv_bcst16(c.bu))), 6);
+			}
+
+			r = gv_packus_s16(rgb[0][0], rgb[0][1]);
+			g = gv_packus_s16(rgb[1][0], rgb[1][1]);
+			b = gv_packus_s16(rgb[2][0], rgb[2][1]);
+		}
+
+		// Scalar version of the above, the results are identical
+		inline void convert_yuv_pixel(const yuv_coefficients& c, u8 y, u8 u, u8 v, u8& r, u8& g, u8& b)
+		{
+			const s32 yv = ((y * c.y_mul) >> 1) - (c.y_offset * c.y_mul / 2) + 32;
+			const s32 us = u - 128;
+			const s32 vs = v - 128;
+
+			r = static_cast<u8>(std::clamp((yv + vs * c.rv) >> 6, 0, 255));
+			g = static_cast<u8>(std::clamp((yv - us * c.gu - vs * c.gv) >> 6, 0, 255));
+			b = static_cast<u8>(std::clamp((yv + us * c.bu) >> 6, 0, 255));
+		}
+
+		template <bool ARGB>
+		inline void store_rgb32(u8* dst, const v128& r, const v128& g, const v128& b, const v128& a)
+		{
+			const v128 lo01 = ARGB ? gv_unpacklo8(a, r) : gv_unpacklo8(r, g);
+			const v128 hi01 = ARGB ? gv_unpackhi8(a, r) : gv_unpackhi8(r, g);
+			const v128 lo23 = ARGB ? gv_unpacklo8(g, b) : gv_unpacklo8(b, a);
+			const v128 hi23 = ARGB ? gv_unpackhi8(g, b) : gv_unpackhi8(b, a);
+
+			v128::storeu(gv_unpacklo16(lo01, lo23), dst, 0);
+			v128::storeu(gv_unpackhi16(lo01, lo23), dst, 1);
+			v128::storeu(gv_unpacklo16(hi01, hi23), dst, 2);
+			v128::storeu(gv_unpackhi16(hi01, hi23), dst, 3);
+		}
+
+		inline void get_chroma_rows(const yuv420_image& src, u32 row, const u8*& src_u, const u8*& src_v)
+		{
+			src_u = src.u + (row / 2) * src.uv_pitch;
+			src_v = src.semi_planar ? src_u + 1 : src.v + (row / 2) * src.uv_pitch;
+		}
+
+		template <bool ARGB>
+		void convert_rgb32_row(const yuv_coefficients& c, const yuv420_image& src, u32 row, u8* out, u8 alpha)
+		{
+			const u8* src_y = src.y + row * src.y_pitch;
+			const u8* src_u;
+			const u8* src_v;
+			get_chroma_rows(src, row, src_u, src_v);
+
+			const usz chroma_step = src.semi_planar ? 2 : 1;
+			const v128 a = gv_bcst8(alpha);
+
+			u32 x = 0;
+
+			// 32 pixels at a time, so that a full vector of chroma samples is consumed
+			for (; x + 32 <= src.width; x += 32)
+			{
+				v128 u, v;
+
+				if (src.semi_planar)
+				{
+					const v128 uv0 = v128::loadu(src_u + x);
+					const v128 uv1 = v128::loadu(src_u + x + 16);
+					u = gv_packtu16(uv0, uv1);
+					v = gv_packtu16(gv_shr16(uv0, 8), gv_shr16(uv1, 8));
+				}
+				else
+				{
+					u = v128::loadu(src_u + x / 2);
+					v = v128::loadu(src_v + x / 2);
+				}
+
+				v128 r, g, b;
+
+				convert_yuv_16(c, v128::loadu(src_y + x), gv_unpacklo8(u, u), gv_unpacklo8(v, v), r, g, b);
+				store_rgb32<ARGB>(out + x * 4, r, g, b, a);
+
+				convert_yuv_16(c, v128::loadu(src_y + x + 16), gv_unpackhi8(u, u), gv_unpackhi8(v, v), r, g, b);
+				store_rgb32<ARGB>(out + x * 4 + 64, r, g, b, a);
+			}
+
+			for (; x < src.width; x++)
+			{
+				u8 r, g, b;
+				convert_yuv_pixel(c, src_y[x], src_u[(x / 2) * chroma_step], src_v[(x / 2) * chroma_step], r, g, b);
+
+				u8* pixel = out + x * 4;
+
+				if constexpr (ARGB)
+				{
+					pixel[0] = alpha; pixel[1] = r; pixel[2] = g; pixel[3] = b;
+				}
+				else
+				{
+					pixel[0] = r; pixel[1] = g; pixel[2] = b; pixel[3] = alpha;
+				}
+			}
+		}
+
+		struct scale_step
+		{
+			u32 index;  // First source sample
+			u32 weight; // Weight of the next sample, 0-256
+		};
+
+		// Sample positions are pixel centers, like swscale's bilinear mode
+		std::vector<scale_step> get_scale_steps(u32 src_size, u32 dst_size)
+		{
+			std::vector<scale_step> result(dst_size);
+
+			for (u32 i = 0; i < dst_size; i++)
+			{
+				const s64 pos = std::max<s64>((s64{2} * i + 1) * src_size * 256 / (s64{2} * dst_size) - 128, 0);
+				const u32 index = static_cast<u32>(pos >> 8);
+
+				result[i] = index + 1 >= src_size ? scale_step{ src_size - 1, 0 } : scale_step{ index, static_cast<u32>(pos & 0xff) };
+			}
+
+			return result;
+		}
+
+		void scale_rgb32_row(const u8* src, u8* dst, const std::vector<scale_step>& steps)
+		{
+			for (usz i = 0; i < steps.size(); i++)
+			{
+				const u8* p0 = src + steps[i].index * 4;
+				const u8* p1 = steps[i].weight ? p0 + 4 : p0;
+				const u32 w1 = steps[i].weight;
+				const u32 w0 = 256 - w1;
+
+				for (u32 ch = 0; ch < 4; ch++)
+				{
+					dst[i * 4 + ch] = static_cast<u8>((p0[ch] * w0 + p1[ch] * w1 + 128) >> 8);
+				}
+			}
+		}
+
+		void blend_rgb32_rows(const u8* row0, const u8* row1, u8* dst, usz size, u32 weight)
+		{
+			if (!weight)
+			{
+				std::memcpy(dst, row0, size);
+				return;
+			}
+
+			const v128 zero{};
+			const v128 w0 = gv_bcst16(static_cast<u16>(256 - weight));
+			const v128 w1 = gv_bcst16(static_cast<u16>(weight));
+			const v128 round = gv_bcst16(128);
+
+			usz i = 0;
+
+			// The weights add up to 256, so the unsigned 16-bit sums can't overflow
+			for (; i + 16 <= size; i += 16)
+			{
+				const v128 a = v128::loadu(row0 + i);
+				const v128 b = v128::loadu(row1 + i);
+
+				const v128 lo = gv_shr16(gv_add16(gv_add16(gv_mul16(gv_unpacklo8(a, zero), w0), gv_mul16(gv_unpacklo8(b, zero), w1)), round), 8);
+				const v128 hi = gv_shr16(gv_add16(gv_add16(gv_mul16(gv_unpackhi8(a, zero), w0), gv_mul16(gv_unpackhi8(b, zero), w1)), round), 8);
+
+				v128::storeu(gv_packus_s16(lo, hi), dst + i);
+			}
+
+			for (; i < size; i++)
+			{
+				dst[i] = static_cast<u8>((row0[i] * (256 - weight) + row1[i] * weight + 128) >> 8);
+			}
+		}
+
+		template <bool ARGB>
+		void yuv420_to_rgb32_scaled(const yuv_coefficients& c, const yuv420_image& src, u8* dst, usz dst_pitch, u32 dst_width, u32 dst_height, u8 alpha)
+		{
+			const auto x_steps = get_scale_steps(src.width, dst_width);
+			const auto y_steps = get_scale_steps(src.height, dst_height);
+
+			// Each source row is converted and scaled horizontally once, the last two are kept for the vertical blend
+			std::vector<u8> line(usz{4} * src.width);
+			std::vector<u8> rows[2];
+			u32 row_index[2] = { umax, umax };
+
+			rows[0].resize(usz{4} * dst_width);
+			rows[1].resize(usz{4} * dst_width);
+
+			const auto get_row = [&](u32 index) -> const u8*
+			{
+				for (u32 i = 0; i < 2; i++)
+				{
+					if (row_index[i] == index)
+					{
+						return rows[i].data();
+					}
+				}
+
+				// Replace the row that is furthest behind
+				const u32 slot = (row_index[0] == umax || (row_index[1] != umax && row_index[0] < row_index[1])) ? 0 : 1;
+
+				convert_rgb32_row<ARGB>(c, src, index, line.data(), alpha);
+				scale_rgb32_row(line.data(), rows[slot].data(), x_steps);
+				row_index[slot] = index;
+				return rows[slot].data();
+			};
+
+			for (u32 y = 0; y < dst_height; y++)
+			{
+				const auto [index, weight] = y_steps[y];
+				const u8* row0 = get_row(index);
+				const u8* row1 = weight ? get_row(index + 1) : row0;
+
+				blend_rgb32_rows(row0, row1, dst + y * dst_pitch, usz{4} * dst_width, weight);
+			}
+		}
+
+		template <bool ARGB>
+		void yuv420_to_rgb32_impl(const yuv420_image& src, u8* dst, usz dst_pitch, u32 dst_width, u32 dst_height, color_matrix matrix, u8 alpha)
+		{
+			const yuv_coefficients c = get_yuv_coefficients(matrix, src.full_range);
+
+			if (dst_width != src.width || dst_height != src.height)
+			{
+				yuv420_to_rgb32_scaled<ARGB>(c, src, dst, dst_pitch, dst_width, dst_height, alpha);
+				return;
+			}
+
+			for (u32 row = 0; row < src.height; row++)
+			{
+				convert_rgb32_row<ARGB>(c, src, row, dst + row * dst_pitch, alpha);
+			}
+		}
+	}
+
+	void yuv420_to_rgb32(const yuv420_image& src, u8* dst, usz dst_pitch, u32 dst_width, u32 dst_height, rgb32_layout layout, color_matrix matrix, u8 alpha)
+	{
+		if (!src.width || !src.height || !dst_width || !dst_height)
+		{
+			return;
+		}
+
+		if (layout == rgb32_layout::argb)
+		{
+			yuv420_to_rgb32_impl<true>(src, dst, dst_pitch, dst_width, dst_height, matrix, alpha);
+		}
+		else
+		{
+			yuv420_to_rgb32_impl<false>(src, dst, dst_pitch, dst_width, dst_height, matrix, alpha);
+		}
+	}
+
+	void yuv420_to_uyvy422(const yuv420_image& src, u8* dst, usz dst_pitch)
+	{
+		const usz chroma_step = src.semi_planar ? 2 : 1;
+
+		for (u32 row = 0; row < src.height; row++)
+		{
+			const u8* src_y = src.y + row * src.y_pitch;
+			const u8* src_u;
+			const u8* src_v;
+			get_chroma_rows(src, row, src_u, src_v);
+
+			u8* out = dst + row * dst_pitch;
+			u32 x = 0;
+
+			for (; x + 32 <= src.width; x += 32)
+			{
+				v128 u, v;
+
+				if (src.semi_planar)
+				{
+					const v128 uv0 = v128::loadu(src_u + x);
+					const v128 uv1 = v128::loadu(src_u + x + 16);
+					u = gv_packtu16(uv0, uv1);
+					v = gv_packtu16(gv_shr16(uv0, 8), gv_shr16(uv1, 8));
+				}
+				else
+				{
+					u = v128::loadu(src_u + x / 2);
+					v = v128::loadu(src_v + x / 2);
+				}
+
+				// U0 Y0 V0 Y1 ...
+				const v128 uv_lo = gv_unpacklo8(u, v);
+				const v128 uv_hi = gv_unpackhi8(u, v);
+				const v128 y0 = v128::loadu(src_y + x);
+				const v128 y1 = v128::loadu(src_y + x + 16);
+
+				v128::storeu(gv_unpacklo8(uv_lo, y0), out + x * 2, 0);
+				v128::storeu(gv_unpackhi8(uv_lo, y0), out + x * 2, 1);
+				v128::storeu(gv_unpacklo8(uv_hi, y1), out + x * 2, 2);
+				v128::storeu(gv_unpackhi8(uv_hi, y1), out + x * 2, 3);
+			}
+
+			for (; x < src.width; x += 2)
+			{
+				u8* pixel = out + x * 2;
+				pixel[0] = src_u[(x / 2) * chroma_step];
+				pixel[1] = src_y[x];
+				pixel[2] = src_v[(x / 2) * chroma_step];
+				pixel[3] = src_y[std::min(x + 1, src.width - 1)];
+			}
+		}
+	}
+
+	void yuv420_to_yuv420p(const yuv420_image& src, u8* dst)
+	{
+		const u32 chroma_width = (src.width + 1) / 2;
+		const u32 chroma_height = (src.height + 1) / 2;
+
+		u8* dst_u = dst + usz{src.width} * src.height;
+		u8* dst_v = dst_u + usz{chroma_width} * chroma_height;
+
+		for (u32 row = 0; row < src.height; row++)
+		{
+			std::memcpy(dst + row * usz{src.width}, src.y + row * src.y_pitch, src.width);
+		}
+
+		for (u32 row = 0; row < chroma_height; row++)
+		{
+			const u8* src_u = src.u + row * src.uv_pitch;
+			u8* out_u = dst_u + row * usz{chroma_width};
+			u8* out_v = dst_v + row * usz{chroma_width};
+
+			if (!src.semi_planar)
+			{
+				std::memcpy(out_u, src_u, chroma_width);
+				std::memcpy(out_v, src.v + row * src.uv_pitch, chroma_width);
+				continue;
+			}
+
+			u32 x = 0;
+
+			for (; x + 16 <= chroma_width; x += 16)
+			{
+				const v128 uv0 = v128::loadu(src_u + x * 2);
+				const v128 uv1 = v128::loadu(src_u + x * 2 + 16);
+				v128::storeu(gv_packtu16(uv0, uv1), out_u + x);
+				v128::storeu(gv_packtu16(gv_shr16(uv0, 8), gv_shr16(uv1, 8)), out_v + x);
+			}
+
+			for (; x < chroma_width; x++)
+			{
+				out_u[x] = src_u[x * 2];
+				out_v[x] = src_u[x * 2 + 1];
+			}
+		}
+	}
+
+	void rgba32_to_argb32(const u8* src, u8* dst, usz count)
+	{
+		usz i = 0;
+
+		// Little endian, rotating each pixel left by one byte moves A in front of R
+		for (; i + 4 <= count; i += 4)
+		{
+			v128::storeu(gv_rol32<8>(v128::loadu(src + i * 4)), dst + i * 4);
+		}
+
+		for (; i < count; i++)
+		{
+			const u8 r = src[i * 4 + 0], g = src[i * 4 + 1], b = src[i * 4 + 2], a = src[i * 4 + 3];
+			dst[i * 4 + 0] = a;
+			dst[i * 4 + 1] = r;
+			dst[i * 4 + 2] = g;
+			dst[i * 4 + 3] = b;
+		}
+	}
+}
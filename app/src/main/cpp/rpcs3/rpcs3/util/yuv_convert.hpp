@@ -0,0 +1,52 @@
+#pragma once
+
+#include "util/types.hpp"
+
+// Pixel format conversion shared by the media HLE modules (cellVdec, cellVpost, image decoders).
+// Works directly on the PS3 output layouts so that no intermediate buffers or swscale contexts are needed.
+// Uses SSE2/NEON through util/simd.hpp, leftover pixels go through a scalar path with identical results.
+namespace utils
+{
+	enum class color_matrix : u8
+	{
+		bt601,
+		bt709,
+	};
+
+	enum class rgb32_layout : u8
+	{
+		rgba,
+		argb,
+	};
+
+	// 4:2:0 source picture, either three planes (YUV420P) or a luma plane and an interleaved UV plane (NV12)
+	struct yuv420_image
+	{
+		const u8* y{};
+		const u8* u{};
+		const u8* v{}; // Ignored if semi_planar
+		usz y_pitch{};
+		usz uv_pitch{};
+		u32 width{};
+		u32 height{};
+		bool semi_planar = false;
+		bool full_range = false;
+	};
+
+	// Converts to packed 32-bit RGB with a constant alpha, scaling bilinearly if the destination size differs
+	void yuv420_to_rgb32(const yuv420_image& src, u8* dst, usz dst_pitch, u32 dst_width, u32 dst_height, rgb32_layout layout, color_matrix matrix, u8 alpha);
+
+	inline void yuv420_to_rgb32(const yuv420_image& src, u8* dst, usz dst_pitch, rgb32_layout layout, color_matrix matrix, u8 alpha)
+	{
+		yuv420_to_rgb32(src, dst, dst_pitch, src.width, src.height, layout, matrix, alpha);
+	}
+
+	// Packed UYVY 4:2:2, chroma rows are repeated
+	void yuv420_to_uyvy422(const yuv420_image& src, u8* dst, usz dst_pitch);
+
+	// Tightly packed planar YUV 4:2:0 (Y plane, then U, then V)
+	void yuv420_to_yuv420p(const yuv420_image& src, u8* dst);
+
+	// Repacks rows of RGBA32 pixels as decoded by the image libraries
+	void rgba32_to_argb32(const u8* src, u8* dst, usz count);
+}
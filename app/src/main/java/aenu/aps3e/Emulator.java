@@ -583,6 +583,7 @@ public class Emulator extends aenu.emulator.Emulator
 	
 	public native MetaInfo meta_info_from_dir(String p) throws RuntimeException;
 	public native MetaInfo meta_info_from_iso(int fd,String iso_uri) throws RuntimeException;
+	public native boolean compress_iso(int iso_fd,int cso_fd);
 	public native boolean install_firmware(int pup_file_fd);
 
 	public boolean install_rap(int pfd,String rap_name){
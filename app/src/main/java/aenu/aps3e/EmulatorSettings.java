@@ -336,6 +336,8 @@ public class EmulatorSettings extends AppCompatActivity {
                     "Core|Allow RSX CPU Preemptions",
                     "Core|Enable Performance Report",
                     "Core|Assume External Debugger",
+                    "Core|Video Decoder Frame Threading",
+                    "Core|Video Decoder Hardware Acceleration",
                     Video$Write_Color_Buffers,
                     "Video|Write Depth Buffer",
                     Video$Read_Color_Buffers,
@@ -357,11 +359,13 @@ public class EmulatorSettings extends AppCompatActivity {
                     "Video|Enable Frame Skip",
                     "Video|Force CPU Blit",
                     "Video|Disable On-Disk Shader Cache",
+                    "Video|Texture Disk Cache",
                     "Video|Disable Vulkan Memory Allocator",
                     "Video|Use full RGB output range",
                     "Video|Strict Texture Flushing",
                     "Video|Multithreaded RSX",
                     "Video|Relaxed ZCULL Sync",
+                    "Video|Predictive ZCULL Reports",
                     "Video|Force Hardware MSAA Resolve",
                     "Video|Debug Program Analyser",
                     "Video|Accurate ZCULL stats",
@@ -384,8 +388,10 @@ public class EmulatorSettings extends AppCompatActivity {
                     "Audio|Dump to file",
                     "Audio|Convert to 16 bit",
                     "Audio|Enable Buffering",
+                    "Audio|Adaptive Buffering",
                     "Audio|Enable Time Stretching",
                     "Audio|Disable Sampling Skip",
+                    "Audio|ATRAC3plus Decoding Cache",
                     "Input/Output|Keep pads connected",
                     "Input/Output|Background input enabled",
                     "Input/Output|Show move cursor",
@@ -423,18 +429,21 @@ public class EmulatorSettings extends AppCompatActivity {
                     "Core|Stub PPU Traps",
                     "Core|Clocks scale",
                     "Core|Usleep Time Addend",
+                    "Core|Video Decoder Threads",
                     "Video|Second Frame Limit",
                     "Video|Consecutive Frames To Draw",
                     "Video|Consecutive Frames To Skip",
                     Video$Resolution_Scale,
                     "Video|Texture LOD Bias Addend",
                     "Video|Minimum Scalable Dimension",
+                    "Video|Texture Disk Cache Size",
                     "Video|Shader Compiler Threads",
                     "Video|Driver Recovery Timeout",
                     "Video|Vblank Rate",
                     "Audio|Master Volume",
                     "Audio|Desired Audio Buffer Duration",
                     "Audio|Time Stretching Threshold",
+                    "Audio|ATRAC3plus Decoding Cache Size",
                     "Core|SPU Reservation Busy Waiting Percentage",
                     "Core|SPU GETLLAR Busy Waiting Percentage",
                     "Core|MFC Commands Shuffling Limit",
@@ -711,9 +711,71 @@ public class MainActivity extends AppCompatActivity {
 				}
 			});
 		}
+		else if(item_id==R.id.compress_iso){
+			compress_iso(adapter.getMetaInfo(position));
+		}
 		return super.onContextItemSelected(item);
 	}
 
+	void compress_iso(Emulator.MetaInfo meta_info){
+		DocumentFile iso=meta_info.iso_uri!=null?DocumentFile.fromSingleUri(this,Uri.parse(meta_info.iso_uri)):null;
+		Uri iso_dir_uri=load_pref_iso_dir(this);
+		if(iso==null||iso.getName()==null||!iso.getName().endsWith(".iso")||iso_dir_uri==null){
+			Toast.makeText(this, R.string.compress_iso_unsupported, Toast.LENGTH_SHORT).show();
+			return;
+		}
+
+		String cso_name=iso.getName().substring(0,iso.getName().length()-4)+".cso";
+		DocumentFile iso_dir=DocumentFile.fromTreeUri(this,iso_dir_uri);
+		if(iso_dir==null||iso_dir.findFile(cso_name)!=null){
+			Toast.makeText(this, R.string.compress_iso_exists, Toast.LENGTH_SHORT).show();
+			return;
+		}
+
+		DocumentFile cso=iso_dir.createFile("application/octet-stream",cso_name);
+		if(cso==null){
+			Toast.makeText(this, R.string.msg_failed, Toast.LENGTH_SHORT).show();
+			return;
+		}
+
+		final int iso_fd,cso_fd;
+		try {
+			ParcelFileDescriptor iso_pfd=getContentResolver().openFileDescriptor(iso.getUri(),"r");
+			ParcelFileDescriptor cso_pfd=getContentResolver().openFileDescriptor(cso.getUri(),"rw");
+			iso_fd=iso_pfd.detachFd();
+			cso_fd=cso_pfd.detachFd();
+			iso_pfd.close();
+			cso_pfd.close();
+		} catch (Exception e) {
+			cso.delete();
+			Toast.makeText(this, e.getMessage(), Toast.LENGTH_SHORT).show();
+			return;
+		}
+
+		(progress_task=new ProgressTask(this)
+				.set_progress_message(getString(R.string.compressing_iso))
+				.set_failed_task(new ProgressTask.UI_Task() {
+					@Override
+					public void run() {
+						cso.delete();
+						Toast.makeText(MainActivity.this, getString(R.string.msg_failed), Toast.LENGTH_LONG).show();
+					}
+				})
+				.set_done_task(new ProgressTask.UI_Task() {
+					@Override
+					public void run() {
+						refresh_game_list();
+					}
+				}))
+				.call(new ProgressTask.Task() {
+					@Override
+					public void run(ProgressTask task) {
+						task.task_handler.sendEmptyMessage(Emulator.get.compress_iso(iso_fd,cso_fd)?ProgressTask.TASK_DONE:ProgressTask.TASK_FAILED);
+						progress_task=null;
+					}
+				});
+	}
+
 	static void copy_file(File src,File dst){
 		try {
 			FileInputStream in=new FileInputStream(src);
@@ -1033,7 +1095,7 @@ public class MainActivity extends AppCompatActivity {
 			if(iso_files==null)
 				return iso_list;
 			for(DocumentFile f:iso_files){
-				if(f.isFile()&&f.getName().endsWith(".iso"))
+				if(f.isFile()&&(f.getName().endsWith(".iso")||f.getName().endsWith(".cso")))
 					iso_list.add(f);
 			}
 			return iso_list;